@@ -26,6 +26,7 @@
 #include "winbase.h"
 #include "wingdi.h"
 #include "winuser.h"
+#include "winreg.h"
 #include "wincrypt.h"
 #include "mmsystem.h" /* DIBINDEX */
 
@@ -3529,11 +3530,154 @@ static void test_simple_graphics(void)
     DeleteDC(mem_dc);
 }
 
+static void draw_large_graphics(HDC hdc, HDC src_dc, int width, int height)
+{
+    TRIVERTEX vrect[] =
+    {
+        { 0,     0,      0xff00, 0x8000, 0x0000, 0x0000 },
+        { width, height, 0x0000, 0x4000, 0xff00, 0x0000 },
+    };
+    TRIVERTEX vtri[] =
+    {
+        { width / 2, 0,      0xff00, 0x0000, 0x0000, 0x0000 },
+        { 0,         height, 0x0000, 0xff00, 0x0000, 0x0000 },
+        { width,     height, 0x0000, 0x0000, 0xff00, 0x0000 },
+    };
+    GRADIENT_RECT rect = { 0, 1 };
+    GRADIENT_TRIANGLE tri = { 0, 1, 2 };
+    BLENDFUNCTION blend = { AC_SRC_OVER, 0, 0x80, 0 };
+    HBRUSH brush, orig_brush;
+
+    brush = CreateSolidBrush(RGB(0x12, 0x34, 0x56));
+    orig_brush = SelectObject(hdc, brush);
+    PatBlt(hdc, 0, 0, width, height, PATCOPY);
+    SelectObject(hdc, orig_brush);
+    DeleteObject(brush);
+
+    brush = CreateHatchBrush(HS_DIAGCROSS, RGB(0xff, 0x80, 0x00));
+    orig_brush = SelectObject(hdc, brush);
+    PatBlt(hdc, 0, 0, width, height / 2, PATINVERT);
+    SelectObject(hdc, orig_brush);
+    DeleteObject(brush);
+
+    GdiGradientFill(hdc, vrect, 2, &rect, 1, GRADIENT_FILL_RECT_V);
+    GdiGradientFill(hdc, vtri, 3, &tri, 1, GRADIENT_FILL_TRIANGLE);
+    GdiAlphaBlend(hdc, 0, 0, width, height, src_dc, 0, 0, width, height, blend);
+}
+
+/* operations on large bitmaps may be split into bands rendered in parallel,
+ * check that the result is the same as when rendering them strip by strip */
+static void test_large_graphics(void)
+{
+    static const int width = 1280, height = 1024, strip = 64;
+    TRIVERTEX vsrc[] =
+    {
+        { 0,     0,      0x0000, 0xff00, 0x8000, 0x0000 },
+        { width, height, 0xff00, 0x0000, 0x4000, 0x0000 },
+    };
+    GRADIENT_RECT rect = { 0, 1 };
+    HBITMAP bitmap, ref_bitmap, src_bitmap;
+    HDC hdc, ref_dc, src_dc;
+    DWORD *bits, *ref_bits;
+    unsigned int i, diff = 0;
+    int y;
+
+    hdc = CreateCompatibleDC(NULL);
+    ref_dc = CreateCompatibleDC(NULL);
+    src_dc = CreateCompatibleDC(NULL);
+    bitmap = CreateBitmap(width, height, 1, 32, NULL);
+    ref_bitmap = CreateBitmap(width, height, 1, 32, NULL);
+    src_bitmap = CreateBitmap(width, height, 1, 24, NULL);
+    ok(bitmap && ref_bitmap && src_bitmap, "failed to create bitmaps\n");
+    SelectObject(hdc, bitmap);
+    SelectObject(ref_dc, ref_bitmap);
+    SelectObject(src_dc, src_bitmap);
+    GdiGradientFill(src_dc, vsrc, 2, &rect, 1, GRADIENT_FILL_RECT_H);
+
+    draw_large_graphics(hdc, src_dc, width, height);
+    for (y = 0; y < height; y += strip)
+    {
+        SaveDC(ref_dc);
+        IntersectClipRect(ref_dc, 0, y, width, y + strip);
+        draw_large_graphics(ref_dc, src_dc, width, height);
+        RestoreDC(ref_dc, -1);
+    }
+
+    bits = malloc(width * height * 4);
+    ref_bits = malloc(width * height * 4);
+    ok(GetBitmapBits(bitmap, width * height * 4, bits) == width * height * 4, "GetBitmapBits failed\n");
+    ok(GetBitmapBits(ref_bitmap, width * height * 4, ref_bits) == width * height * 4, "GetBitmapBits failed\n");
+    for (i = 0; i < width * height; i++)
+        if (bits[i] != ref_bits[i] && !diff++)
+            ok(0, "pixel %u,%u got %08lx expected %08lx\n", i % width, i / width, bits[i], ref_bits[i]);
+    ok(!diff, "%u pixels differ\n", diff);
+
+    free(bits);
+    free(ref_bits);
+    DeleteDC(hdc);
+    DeleteDC(ref_dc);
+    DeleteDC(src_dc);
+    DeleteObject(bitmap);
+    DeleteObject(ref_bitmap);
+    DeleteObject(src_bitmap);
+}
+
+static void test_parallel_rendering(const char *argv0)
+{
+    PROCESS_INFORMATION info;
+    STARTUPINFOA startup;
+    char cmdline[MAX_PATH];
+    DWORD disposition;
+    HKEY key;
+    LONG ret;
+
+    test_large_graphics();
+
+    /* run it again with Wine's parallel rendering enabled */
+    ret = RegCreateKeyExA(HKEY_CURRENT_USER, "Software\\Wine\\Gdi", 0, NULL, 0, KEY_ALL_ACCESS, NULL,
+                          &key, &disposition);
+    ok(!ret, "RegCreateKeyExA failed %ld\n", ret);
+    ret = RegSetValueExA(key, "ParallelRendering", 0, REG_SZ, (const BYTE *)"y", 2);
+    ok(!ret, "RegSetValueExA failed %ld\n", ret);
+
+    memset(&startup, 0, sizeof(startup));
+    startup.cb = sizeof(startup);
+    sprintf(cmdline, "\"%s\" dib large", argv0);
+    ok(CreateProcessA(NULL, cmdline, NULL, NULL, FALSE, 0, NULL, NULL, &startup, &info),
+       "CreateProcess failed %lu\n", GetLastError());
+    wait_child_process(&info);
+    CloseHandle(info.hProcess);
+    CloseHandle(info.hThread);
+
+    if (disposition == REG_CREATED_NEW_KEY)
+    {
+        RegCloseKey(key);
+        RegDeleteKeyA(HKEY_CURRENT_USER, "Software\\Wine\\Gdi");
+    }
+    else
+    {
+        RegDeleteValueA(key, "ParallelRendering");
+        RegCloseKey(key);
+    }
+}
+
 START_TEST(dib)
 {
+    char **argv;
+    int argc;
+
+    argc = winetest_get_mainargs(&argv);
+    if (argc >= 3 && !strcmp(argv[2], "large"))
+    {
+        test_large_graphics();
+        return;
+    }
+
     CryptAcquireContextW(&crypt_prov, NULL, NULL, PROV_RSA_FULL, CRYPT_VERIFYCONTEXT);
 
     test_simple_graphics();
 
     CryptReleaseContext(crypt_prov, 0);
+
+    test_parallel_rendering(argv[0]);
 }
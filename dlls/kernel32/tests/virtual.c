@@ -2489,6 +2489,9 @@ static void test_write_watch(void)
 static void test_largepages(void)
 {
     const KUSER_SHARED_DATA *user_shared_data = (void *)0x7ffe0000;
+    TOKEN_PRIVILEGES privs;
+    HANDLE token, mapping;
+    char *base, *addr;
     SIZE_T size;
 
     if (!pGetLargePageMinimum) {
@@ -2502,6 +2505,60 @@ static void test_largepages(void)
 
     ok( user_shared_data->LargePageMinimum == size, "wrong large page minimum %lx / %Ix\n",
         user_shared_data->LargePageMinimum, size );
+    if (!size) return;
+
+    /* find an address aligned on the large page size */
+    base = VirtualAlloc( NULL, 2 * size, MEM_RESERVE, PAGE_NOACCESS );
+    ok( base != NULL, "VirtualAlloc failed err %lu\n", GetLastError() );
+    VirtualFree( base, 0, MEM_RELEASE );
+    base = (char *)(((ULONG_PTR)base + size - 1) & ~(size - 1));
+
+    SetLastError( 0xdeadbeef );
+    addr = VirtualAlloc( NULL, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE );
+    ok( !addr, "MEM_LARGE_PAGES succeeded without privilege\n" );
+    ok( GetLastError() == ERROR_PRIVILEGE_NOT_HELD, "got %lu\n", GetLastError() );
+    SetLastError( 0xdeadbeef );
+    mapping = CreateFileMappingA( INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE | SEC_COMMIT | SEC_LARGE_PAGES,
+                                  0, size, NULL );
+    ok( !mapping, "SEC_LARGE_PAGES succeeded without privilege\n" );
+    ok( GetLastError() == ERROR_PRIVILEGE_NOT_HELD, "got %lu\n", GetLastError() );
+
+    privs.PrivilegeCount = 1;
+    privs.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+    if (!OpenProcessToken( GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES, &token ) ||
+        !LookupPrivilegeValueA( NULL, SE_LOCK_MEMORY_NAME, &privs.Privileges[0].Luid ) ||
+        !AdjustTokenPrivileges( token, FALSE, &privs, sizeof(privs), NULL, NULL ) ||
+        GetLastError() == ERROR_NOT_ALL_ASSIGNED)
+    {
+        skip( "cannot enable SE_LOCK_MEMORY_NAME privilege\n" );
+        CloseHandle( token );
+        return;
+    }
+
+    SetLastError( 0xdeadbeef );
+    addr = VirtualAlloc( NULL, size + size / 2, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE );
+    ok( !addr, "MEM_LARGE_PAGES succeeded with a misaligned size\n" );
+    ok( GetLastError() == ERROR_INVALID_PARAMETER, "got %lu\n", GetLastError() );
+    SetLastError( 0xdeadbeef );
+    addr = VirtualAlloc( base + si.dwAllocationGranularity, size,
+                         MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE );
+    ok( !addr, "MEM_LARGE_PAGES succeeded with a misaligned base\n" );
+    ok( GetLastError() == ERROR_INVALID_PARAMETER, "got %lu\n", GetLastError() );
+
+    SetLastError( 0xdeadbeef );
+    addr = VirtualAlloc( NULL, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE );
+    ok( addr != NULL || broken(GetLastError() == ERROR_NO_SYSTEM_RESOURCES), /* no contiguous memory */
+        "MEM_LARGE_PAGES failed err %lu\n", GetLastError() );
+    if (addr)
+    {
+        ok( !((ULONG_PTR)addr & (size - 1)), "got misaligned address %p\n", addr );
+        memset( addr, 0x55, size );
+        ok( VirtualFree( addr, 0, MEM_RELEASE ), "VirtualFree failed err %lu\n", GetLastError() );
+    }
+
+    privs.Privileges[0].Attributes = 0;
+    AdjustTokenPrivileges( token, FALSE, &privs, sizeof(privs), NULL, NULL );
+    CloseHandle( token );
 }
 
 #if defined(__i386__) || defined(__x86_64__)
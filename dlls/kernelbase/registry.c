@@ -1638,9 +1638,9 @@ LSTATUS WINAPI DECLSPEC_HOTPATCH RegQueryValueExW( HKEY hkey, LPCWSTR name, LPDW
 {
     NTSTATUS status;
     UNICODE_STRING name_str;
-    DWORD total_size;
+    DWORD total_size, value_type;
     char buffer[256], *buf_ptr = buffer;
-    KEY_VALUE_PARTIAL_INFORMATION *info = (KEY_VALUE_PARTIAL_INFORMATION *)buffer;
+    KEY_VALUE_PARTIAL_INFORMATION *info;
     static const int info_size = offsetof( KEY_VALUE_PARTIAL_INFORMATION, Data );
 
     TRACE("(%p,%s,%p,%p,%p,%p=%ld)\n",
@@ -1656,15 +1656,26 @@ LSTATUS WINAPI DECLSPEC_HOTPATCH RegQueryValueExW( HKEY hkey, LPCWSTR name, LPDW
 
     RtlInitUnicodeString( &name_str, name );
 
-    if (data) total_size = min( sizeof(buffer), *count + info_size );
+    if (data)
+    {
+        total_size = min( sizeof(buffer), *count + info_size );
+        /* a caller buffer larger than ours can hold larger values in a single query,
+         * the data is moved over the information header afterwards */
+        if (*count > sizeof(buffer) && !((ULONG_PTR)data % sizeof(ULONG)))
+        {
+            buf_ptr = (char *)data;
+            total_size = *count;
+        }
+    }
     else
     {
         total_size = info_size;
         if (count) *count = 0;
     }
+    info = (KEY_VALUE_PARTIAL_INFORMATION *)buf_ptr;
 
     status = NtQueryValueKey( hkey, &name_str, KeyValuePartialInformation,
-                              buffer, total_size, &total_size );
+                              buf_ptr, total_size, &total_size );
     if (status && status != STATUS_BUFFER_OVERFLOW) goto done;
 
     if (data)
@@ -1672,7 +1683,7 @@ LSTATUS WINAPI DECLSPEC_HOTPATCH RegQueryValueExW( HKEY hkey, LPCWSTR name, LPDW
         /* retry with a dynamically allocated buffer */
         while (status == STATUS_BUFFER_OVERFLOW && total_size - info_size <= *count)
         {
-            if (buf_ptr != buffer) HeapFree( GetProcessHeap(), 0, buf_ptr );
+            if (buf_ptr != buffer && buf_ptr != (char *)data) HeapFree( GetProcessHeap(), 0, buf_ptr );
             if (!(buf_ptr = HeapAlloc( GetProcessHeap(), 0, total_size )))
                 return ERROR_NOT_ENOUGH_MEMORY;
             info = (KEY_VALUE_PARTIAL_INFORMATION *)buf_ptr;
@@ -1680,12 +1691,13 @@ LSTATUS WINAPI DECLSPEC_HOTPATCH RegQueryValueExW( HKEY hkey, LPCWSTR name, LPDW
                                       buf_ptr, total_size, &total_size );
         }
 
+        value_type = info->Type;
         if (!status)
         {
-            memcpy( data, buf_ptr + info_size, total_size - info_size );
+            memmove( data, buf_ptr + info_size, total_size - info_size );
             /* if the type is REG_SZ and data is not 0-terminated
              * and there is enough space in the buffer NT appends a \0 */
-            if (total_size - info_size <= *count-sizeof(WCHAR) && is_string(info->Type))
+            if (total_size - info_size <= *count-sizeof(WCHAR) && is_string(value_type))
             {
                 WCHAR *ptr = (WCHAR *)(data + total_size - info_size);
                 if (ptr > (WCHAR *)data && ptr[-1]) *ptr = 0;
@@ -1693,13 +1705,17 @@ LSTATUS WINAPI DECLSPEC_HOTPATCH RegQueryValueExW( HKEY hkey, LPCWSTR name, LPDW
         }
         else if (status != STATUS_BUFFER_OVERFLOW) goto done;
     }
-    else status = STATUS_SUCCESS;
+    else
+    {
+        value_type = info->Type;
+        status = STATUS_SUCCESS;
+    }
 
-    if (type) *type = info->Type;
+    if (type) *type = value_type;
     if (count) *count = total_size - info_size;
 
  done:
-    if (buf_ptr != buffer) HeapFree( GetProcessHeap(), 0, buf_ptr );
+    if (buf_ptr != buffer && buf_ptr != (char *)data) HeapFree( GetProcessHeap(), 0, buf_ptr );
     return RtlNtStatusToDosError(status);
 }
 
@@ -140,8 +140,14 @@ typedef struct _wine_modref
     struct file_id        id;
     ULONG                 CheckSum;
     BOOL                  system;
+    DWORD                *export_hash;      /* hash table of export name indices, built on demand */
+    DWORD                 export_hash_size;
+    DWORD                 export_lookups;   /* number of name lookups not resolved by the hint */
 } WINE_MODREF;
 
+/* number of name lookups in a module before building its export hash table */
+#define EXPORT_HASH_MIN_LOOKUPS 32
+
 static UINT tls_module_count = 32;     /* number of modules with TLS directory */
 static IMAGE_TLS_DIRECTORY *tls_dirs;  /* array of TLS directories */
 
@@ -1077,6 +1083,68 @@ static int find_name_in_exports( HMODULE module, const IMAGE_EXPORT_DIRECTORY *e
 }
 
 
+static inline DWORD hash_export_name( const char *name )
+{
+    DWORD hash = 0;
+    while (*name) hash = hash * 65599 + (unsigned char)*name++;
+    return hash;
+}
+
+
+/*************************************************************************
+ *		build_export_hash
+ *
+ * Build the export name hash table of a module.
+ */
+static BOOL build_export_hash( WINE_MODREF *wm, const IMAGE_EXPORT_DIRECTORY *exports )
+{
+    const DWORD *names = get_rva( wm->ldr.DllBase, exports->AddressOfNames );
+    DWORD i, pos, size = 16;
+
+    while (size < 2 * exports->NumberOfNames) size *= 2;
+    if (!(wm->export_hash = RtlAllocateHeap( GetProcessHeap(), HEAP_ZERO_MEMORY,
+                                             size * sizeof(*wm->export_hash) )))
+        return FALSE;
+    wm->export_hash_size = size;
+
+    for (i = 0; i < exports->NumberOfNames; i++)
+    {
+        pos = hash_export_name( get_rva( wm->ldr.DllBase, names[i] )) & (size - 1);
+        while (wm->export_hash[pos]) pos = (pos + 1) & (size - 1);
+        wm->export_hash[pos] = i + 1;
+    }
+    return TRUE;
+}
+
+
+/*************************************************************************
+ *		find_name_in_export_hash
+ *
+ * Helper for find_named_export. Same as find_name_in_exports, but uses
+ * a hash table once the module has been searched often enough.
+ * The loader_section must be locked while calling this function.
+ */
+static int find_name_in_export_hash( HMODULE module, const IMAGE_EXPORT_DIRECTORY *exports, const char *name )
+{
+    const WORD *ordinals = get_rva( module, exports->AddressOfNameOrdinals );
+    const DWORD *names = get_rva( module, exports->AddressOfNames );
+    WINE_MODREF *wm = get_modref( module );
+    DWORD pos, index;
+
+    if (!wm || (!wm->export_hash && (++wm->export_lookups < EXPORT_HASH_MIN_LOOKUPS ||
+                                      !build_export_hash( wm, exports ))))
+        return find_name_in_exports( module, exports, name );
+
+    pos = hash_export_name( name ) & (wm->export_hash_size - 1);
+    while ((index = wm->export_hash[pos]))
+    {
+        if (!strcmp( get_rva( module, names[index - 1] ), name )) return ordinals[index - 1];
+        pos = (pos + 1) & (wm->export_hash_size - 1);
+    }
+    return -1;
+}
+
+
 /*************************************************************************
  *		find_named_export
  *
@@ -1099,8 +1167,8 @@ static FARPROC find_named_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY *
             return find_ordinal_export( module, exports, exp_size, ordinals[hint], load_path, importer, is_dynamic );
     }
 
-    /* then do a binary search */
-    if ((ordinal = find_name_in_exports( module, exports, name )) == -1) return NULL;
+    /* then do a binary search, or a hash lookup for frequently searched modules */
+    if ((ordinal = find_name_in_export_hash( module, exports, name )) == -1) return NULL;
     return find_ordinal_export( module, exports, exp_size, ordinal, load_path, importer, is_dynamic );
 
 }
@@ -4060,6 +4128,7 @@ static void free_modref( WINE_MODREF *wm )
     NtUnmapViewOfSection( NtCurrentProcess(), wm->ldr.DllBase );
     if (cached_modref == wm) cached_modref = NULL;
     RtlFreeUnicodeString( &wm->ldr.FullDllName );
+    RtlFreeHeap( GetProcessHeap(), 0, wm->export_hash );
     RtlFreeHeap( GetProcessHeap(), 0, wm );
 }
 
@@ -7355,6 +7355,82 @@ static void test_set_io_completion_ex(void)
     CloseHandle(completion);
 }
 
+static void test_read_write_scatter_gather(void)
+{
+    FILE_SEGMENT_ELEMENT segments[5];
+    IO_STATUS_BLOCK io;
+    LARGE_INTEGER offset;
+    NTSTATUS status;
+    SYSTEM_INFO si;
+    HANDLE file, event;
+    unsigned int i;
+    char *pages;
+    DWORD ret;
+
+    file = create_temp_file( FILE_FLAG_OVERLAPPED | FILE_FLAG_NO_BUFFERING );
+    if (!file) return;
+    event = CreateEventW( NULL, FALSE, FALSE, NULL );
+    GetSystemInfo( &si );
+    pages = VirtualAlloc( NULL, 8 * si.dwPageSize, MEM_COMMIT, PAGE_READWRITE );
+    ok( pages != NULL, "VirtualAlloc failed err %lu\n", GetLastError() );
+
+    /* a single call spanning several pages, at a non-zero offset */
+    memset( segments, 0, sizeof(segments) );
+    for (i = 0; i < 4; i++)
+    {
+        memset( pages + i * si.dwPageSize, 'a' + i, si.dwPageSize );
+        segments[i].Buffer = pages + (3 - i) * si.dwPageSize;
+    }
+    offset.QuadPart = 2 * si.dwPageSize;
+    io.Status = 0xdeadbeef;
+    io.Information = 0xdeadbeef;
+    status = NtWriteFileGather( file, event, NULL, NULL, &io, segments, 4 * si.dwPageSize, &offset, NULL );
+    ok( status == STATUS_SUCCESS || status == STATUS_PENDING, "got status %#lx\n", status );
+    ret = WaitForSingleObject( event, 1000 );
+    ok( !ret, "wait returned %#lx\n", ret );
+    ok( io.Status == STATUS_SUCCESS, "got status %#lx\n", io.Status );
+    ok( io.Information == 4 * si.dwPageSize, "got size %Iu\n", io.Information );
+
+    memset( pages + 4 * si.dwPageSize, 0, 4 * si.dwPageSize );
+    memset( segments, 0, sizeof(segments) );
+    for (i = 0; i < 3; i++) segments[i].Buffer = pages + (4 + i) * si.dwPageSize;
+    offset.QuadPart = 3 * si.dwPageSize;
+    io.Status = 0xdeadbeef;
+    io.Information = 0xdeadbeef;
+    status = NtReadFileScatter( file, event, NULL, NULL, &io, segments, 3 * si.dwPageSize, &offset, NULL );
+    ok( status == STATUS_SUCCESS || status == STATUS_PENDING, "got status %#lx\n", status );
+    ret = WaitForSingleObject( event, 1000 );
+    ok( !ret, "wait returned %#lx\n", ret );
+    ok( io.Status == STATUS_SUCCESS, "got status %#lx\n", io.Status );
+    ok( io.Information == 3 * si.dwPageSize, "got size %Iu\n", io.Information );
+    for (i = 0; i < 3; i++)
+    {
+        const char *page = pages + (4 + i) * si.dwPageSize;
+        ok( page[0] == 'c' - i && page[si.dwPageSize - 1] == 'c' - i,
+            "page %u: got %c, %c\n", i, page[0], page[si.dwPageSize - 1] );
+    }
+
+    /* reads past the end of file are truncated */
+    memset( pages + 4 * si.dwPageSize, 0, 4 * si.dwPageSize );
+    for (i = 0; i < 4; i++) segments[i].Buffer = pages + (4 + i) * si.dwPageSize;
+    offset.QuadPart = 4 * si.dwPageSize;
+    io.Status = 0xdeadbeef;
+    io.Information = 0xdeadbeef;
+    status = NtReadFileScatter( file, event, NULL, NULL, &io, segments, 4 * si.dwPageSize, &offset, NULL );
+    ok( status == STATUS_SUCCESS || status == STATUS_PENDING, "got status %#lx\n", status );
+    ret = WaitForSingleObject( event, 1000 );
+    ok( !ret, "wait returned %#lx\n", ret );
+    ok( io.Status == STATUS_SUCCESS, "got status %#lx\n", io.Status );
+    ok( io.Information == 2 * si.dwPageSize, "got size %Iu\n", io.Information );
+    ok( pages[4 * si.dwPageSize] == 'b', "got %c\n", pages[4 * si.dwPageSize] );
+    ok( pages[6 * si.dwPageSize - 1] == 'a', "got %c\n", pages[6 * si.dwPageSize - 1] );
+    ok( !pages[6 * si.dwPageSize], "got %#x\n", pages[6 * si.dwPageSize] );
+
+    VirtualFree( pages, 0, MEM_RELEASE );
+    CloseHandle( event );
+    CloseHandle( file );
+}
+
 static void test_file_map_large_size(void)
 {
     char temp_path[MAX_PATH], source[MAX_PATH];
@@ -7494,4 +7570,5 @@ START_TEST(file)
     test_mailslot_name();
     test_reparse_points();
     test_file_map_large_size();
+    test_read_write_scatter_gather();
 }
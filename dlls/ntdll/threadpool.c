@@ -113,6 +113,7 @@ struct threadpool
     int                     min_workers;
     int                     num_workers;
     int                     num_busy_workers;
+    int                     num_idle_workers;
     HANDLE                  compl_port;
     TP_POOL_STACK_INFORMATION stack_info;
 };
@@ -1201,11 +1202,11 @@ static void CALLBACK timerqueue_thread_proc( void *param )
 }
 
 /***********************************************************************
- *           tp_new_worker_thread    (internal)
+ *           tp_create_worker_thread    (internal)
  *
- * Create and account a new worker thread for the desired pool.
+ * Create a worker thread for the desired pool, without accounting it.
  */
-static NTSTATUS tp_new_worker_thread( struct threadpool *pool )
+static NTSTATUS tp_create_worker_thread( struct threadpool *pool )
 {
     HANDLE thread;
     NTSTATUS status;
@@ -1213,11 +1214,25 @@ static NTSTATUS tp_new_worker_thread( struct threadpool *pool )
     status = RtlCreateUserThread( GetCurrentProcess(), NULL, FALSE, 0,
                                   pool->stack_info.StackReserve, pool->stack_info.StackCommit,
                                   threadpool_worker_proc, pool, &thread, NULL );
+    if (status == STATUS_SUCCESS)
+        NtClose( thread );
+    return status;
+}
+
+/***********************************************************************
+ *           tp_new_worker_thread    (internal)
+ *
+ * Create and account a new worker thread for the desired pool.
+ */
+static NTSTATUS tp_new_worker_thread( struct threadpool *pool )
+{
+    NTSTATUS status;
+
+    status = tp_create_worker_thread( pool );
     if (status == STATUS_SUCCESS)
     {
         InterlockedIncrement( &pool->refcount );
         pool->num_workers++;
-        NtClose( thread );
     }
     return status;
 }
@@ -1780,6 +1795,7 @@ static NTSTATUS tp_threadpool_alloc( struct threadpool **out )
     pool->min_workers             = 0;
     pool->num_workers             = 0;
     pool->num_busy_workers        = 0;
+    pool->num_idle_workers        = 0;
     pool->stack_info.StackReserve = nt->OptionalHeader.SizeOfStackReserve;
     pool->stack_info.StackCommit  = nt->OptionalHeader.SizeOfStackCommit;
 
@@ -2077,17 +2093,23 @@ static void tp_object_prio_queue( struct threadpool_object *object )
 static void tp_object_submit( struct threadpool_object *object, BOOL signaled )
 {
     struct threadpool *pool = object->pool;
-    NTSTATUS status = STATUS_UNSUCCESSFUL;
+    BOOL new_worker = FALSE;
 
     assert( !object->shutdown );
     assert( !pool->shutdown );
 
     RtlEnterCriticalSection( &pool->cs );
 
-    /* Start new worker threads if required. */
+    /* Start new worker threads if required. Only the slot is accounted here,
+     * the thread is created after leaving the critical section, so that other
+     * submitters and the workers don't have to wait for the server call. */
     if (pool->num_busy_workers >= pool->num_workers &&
         pool->num_workers < pool->max_workers)
-        status = tp_new_worker_thread( pool );
+    {
+        InterlockedIncrement( &pool->refcount );
+        pool->num_workers++;
+        new_worker = TRUE;
+    }
 
     /* Queue work item and increment refcount. */
     InterlockedIncrement( &object->refcount );
@@ -2098,14 +2120,23 @@ static void tp_object_submit( struct threadpool_object *object, BOOL signaled )
     if (object->type == TP_OBJECT_TYPE_WAIT && signaled)
         object->u.wait.signaled++;
 
-    /* No new thread started - wake up one existing thread. */
-    if (status != STATUS_SUCCESS)
+    /* No new thread started - wake up one existing thread. Busy workers pick up
+     * the item on their own before going to sleep, so waking is only needed
+     * when some threads are actually waiting. */
+    if (!new_worker && pool->num_idle_workers)
+        RtlWakeConditionVariable( &pool->update_event );
+
+    RtlLeaveCriticalSection( &pool->cs );
+
+    if (new_worker && tp_create_worker_thread( pool ) != STATUS_SUCCESS)
     {
+        RtlEnterCriticalSection( &pool->cs );
+        pool->num_workers--;
         assert( pool->num_workers > 0 );
         RtlWakeConditionVariable( &pool->update_event );
+        RtlLeaveCriticalSection( &pool->cs );
+        InterlockedDecrement( &pool->refcount );
     }
-
-    RtlLeaveCriticalSection( &pool->cs );
 }
 
 /***********************************************************************
@@ -2439,6 +2470,7 @@ static void CALLBACK threadpool_worker_proc( void *param )
 {
     struct threadpool *pool = param;
     LARGE_INTEGER timeout;
+    NTSTATUS status;
     struct list *ptr;
 
     TRACE( "starting worker thread for pool %p\n", pool );
@@ -2476,8 +2508,11 @@ static void CALLBACK threadpool_worker_proc( void *param )
          * min_workers == 0, then objcount is used to detect if the last thread
          * can be terminated. */
         timeout.QuadPart = (ULONGLONG)THREADPOOL_WORKER_TIMEOUT * -10000;
-        if (RtlSleepConditionVariableCS( &pool->update_event, &pool->cs, &timeout ) == STATUS_TIMEOUT &&
-            !threadpool_get_next_item( pool ) && (pool->num_workers > max( pool->min_workers, 1 ) ||
+        pool->num_idle_workers++;
+        status = RtlSleepConditionVariableCS( &pool->update_event, &pool->cs, &timeout );
+        pool->num_idle_workers--;
+        if (status == STATUS_TIMEOUT && !threadpool_get_next_item( pool ) &&
+            (pool->num_workers > max( pool->min_workers, 1 ) ||
             (!pool->min_workers && !pool->objcount)))
         {
             break;
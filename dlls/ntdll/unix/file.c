@@ -52,6 +52,7 @@
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #ifdef HAVE_SYS_ATTR_H
 #include <sys/attr.h>
 #endif
@@ -174,6 +175,8 @@ typedef struct
 
 #define MAX_IGNORED_FILES 4
 
+#define MAX_SEGMENT_IOV 256  /* max number of scatter/gather pages per system call */
+
 #ifndef XATTR_USER_PREFIX
 # define XATTR_USER_PREFIX "user."
 #endif
@@ -241,6 +244,23 @@ static const unsigned int dir_data_names_initial_size  = 64;
 static struct dir_data **dir_data_cache;
 static unsigned int dir_data_cache_size;
 
+/* cache of directory contents for case-insensitive file lookups */
+struct dir_lookup_cache
+{
+    struct dir_data *data;           /* directory names, NULL if unused */
+    time_t           mtime;          /* directory modification time */
+    long             mtime_nsec;
+    unsigned int     last_use;       /* value of the use counter when last used */
+    unsigned int     hash_size;      /* size of the hash table, a power of 2 */
+    unsigned int    *hash;           /* 2 * names index + 1 (+ 1 for short names), 0 if free */
+};
+
+#define DIR_LOOKUP_CACHE_SIZE 16
+
+static struct dir_lookup_cache dir_lookup_cache[DIR_LOOKUP_CACHE_SIZE];
+static unsigned int dir_lookup_counter;
+static pthread_mutex_t dir_lookup_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 static BOOL show_dot_files;
 static mode_t start_umask;
 
@@ -2988,6 +3008,168 @@ NTSTATUS WINAPI NtQueryDirectoryFile( HANDLE handle, HANDLE event, PIO_APC_ROUTI
 }
 
 
+/* hash a file name for the directory lookup cache */
+static unsigned int hash_lookup_name( const WCHAR *name, int length )
+{
+    unsigned int hash = 0;
+
+    while (length-- > 0) hash = hash * 65599 + towupper( *name++ );
+    return hash;
+}
+
+static inline long get_mtime_nsec( const struct stat *st )
+{
+#ifdef HAVE_STRUCT_STAT_ST_MTIM
+    return st->st_mtim.tv_nsec;
+#elif defined(HAVE_STRUCT_STAT_ST_MTIMESPEC)
+    return st->st_mtimespec.tv_nsec;
+#else
+    return 0;
+#endif
+}
+
+static void add_lookup_hash( struct dir_lookup_cache *cache, const WCHAR *name, unsigned int entry )
+{
+    unsigned int i = hash_lookup_name( name, wcslen( name )) & (cache->hash_size - 1);
+
+    while (cache->hash[i]) i = (i + 1) & (cache->hash_size - 1);
+    cache->hash[i] = entry;
+}
+
+static void free_lookup_cache( struct dir_lookup_cache *cache )
+{
+    free_dir_data( cache->data );
+    free( cache->hash );
+    memset( cache, 0, sizeof(*cache) );
+}
+
+/***********************************************************************
+ *           read_lookup_cache
+ *
+ * Read the names of a directory into a lookup cache entry.
+ */
+static BOOL read_lookup_cache( struct dir_lookup_cache *cache, int root_fd, const char *unix_name,
+                               const struct stat *st )
+{
+    WCHAR long_name[MAX_DIR_ENTRY_LEN + 1], short_name[13];
+    struct dir_data *data;
+    struct dirent *de;
+    unsigned int i;
+    DIR *dir;
+    int fd, len;
+
+    if ((fd = openat( root_fd, unix_name, O_RDONLY | O_DIRECTORY )) == -1) return FALSE;
+    if (!(dir = fdopendir( fd )))
+    {
+        close( fd );
+        return FALSE;
+    }
+    if (!(data = calloc( 1, sizeof(*data) ))) goto failed;
+
+    while ((de = readdir( dir )))
+    {
+        len = ntdll_umbstowcs( de->d_name, strlen(de->d_name), long_name, MAX_DIR_ENTRY_LEN );
+        long_name[len] = 0;
+        len = is_legal_8dot3_name( long_name, len ) ? 0 : hash_short_file_name( long_name, len, short_name );
+        short_name[len] = 0;
+        if (!add_dir_data_names( data, long_name, short_name, de->d_name )) goto failed;
+    }
+    closedir( dir );
+
+    cache->hash_size = 16;
+    while (cache->hash_size < 4 * data->count) cache->hash_size *= 2;
+    if (!(cache->hash = calloc( cache->hash_size, sizeof(*cache->hash) )))
+    {
+        free_dir_data( data );
+        return FALSE;
+    }
+    /* add the names in directory order, so that the first match is found first */
+    for (i = 0; i < data->count; i++)
+    {
+        add_lookup_hash( cache, data->names[i].long_name, 2 * i + 1 );
+        if (data->names[i].short_name[0]) add_lookup_hash( cache, data->names[i].short_name, 2 * i + 2 );
+    }
+    data->id.dev = st->st_dev;
+    data->id.ino = st->st_ino;
+    cache->data = data;
+    cache->mtime = st->st_mtime;
+    cache->mtime_nsec = get_mtime_nsec( st );
+    return TRUE;
+
+failed:
+    closedir( dir );
+    free_dir_data( data );
+    return FALSE;
+}
+
+
+/***********************************************************************
+ *           find_file_in_dir_cache
+ *
+ * Find a file using the cached contents of its directory, reading them if needed.
+ * Returns FALSE if the directory contents can't be cached.
+ */
+static BOOL find_file_in_dir_cache( int root_fd, char *unix_name, int pos, const WCHAR *name, int length,
+                                    BOOLEAN is_name_8_dot_3, NTSTATUS *status )
+{
+    struct dir_lookup_cache *cache = NULL;
+    const struct dir_data_names *names;
+    const WCHAR *str;
+    unsigned int i, entry;
+    struct stat st;
+
+    if (fstatat( root_fd, unix_name, &st, 0 ) == -1) return FALSE;
+    /* a recent modification may be followed by another one with the same timestamp */
+    if (st.st_mtime >= time( NULL ) - 1) return FALSE;
+
+    mutex_lock( &dir_lookup_mutex );
+
+    for (i = 0; i < DIR_LOOKUP_CACHE_SIZE; i++)
+    {
+        struct dir_lookup_cache *entry = &dir_lookup_cache[i];
+
+        if (entry->data && entry->data->id.dev == st.st_dev && entry->data->id.ino == st.st_ino)
+        {
+            cache = entry;
+            break;
+        }
+        if (!cache || entry->last_use < cache->last_use) cache = entry;
+    }
+
+    if (!cache->data || cache->data->id.dev != st.st_dev || cache->data->id.ino != st.st_ino ||
+        cache->mtime != st.st_mtime || cache->mtime_nsec != get_mtime_nsec( &st ))
+    {
+        free_lookup_cache( cache );
+        if (!read_lookup_cache( cache, root_fd, unix_name, &st ))
+        {
+            mutex_unlock( &dir_lookup_mutex );
+            return FALSE;
+        }
+        TRACE( "cached %u names for %s\n", cache->data->count, debugstr_a( unix_name ));
+    }
+    cache->last_use = ++dir_lookup_counter;
+
+    *status = STATUS_OBJECT_NAME_NOT_FOUND;
+    for (i = hash_lookup_name( name, length ) & (cache->hash_size - 1); (entry = cache->hash[i]);
+         i = (i + 1) & (cache->hash_size - 1))
+    {
+        names = &cache->data->names[(entry - 1) / 2];
+        if (entry & 1) str = names->long_name;
+        else if (is_name_8_dot_3) str = names->short_name;
+        else continue;
+
+        if (wcsnicmp( str, name, length ) || str[length]) continue;
+        unix_name[pos - 1] = '/';
+        strcpy( unix_name + pos, names->unix_name );
+        *status = STATUS_SUCCESS;
+        break;
+    }
+
+    mutex_unlock( &dir_lookup_mutex );
+    return TRUE;
+}
+
+
 /***********************************************************************
  *           find_file_in_dir
  *
@@ -3000,6 +3182,7 @@ static NTSTATUS find_file_in_dir( int root_fd, char *unix_name, int pos, const W
 {
     WCHAR buffer[MAX_DIR_ENTRY_LEN];
     BOOLEAN is_name_8_dot_3;
+    NTSTATUS status;
     DIR *dir;
     struct dirent *de;
     struct stat st;
@@ -3078,6 +3261,12 @@ static NTSTATUS find_file_in_dir( int root_fd, char *unix_name, int pos, const W
     }
 #endif /* VFAT_IOCTL_READDIR_BOTH */
 
+    if (find_file_in_dir_cache( root_fd, unix_name, pos, name, length, is_name_8_dot_3, &status ))
+    {
+        if (status) goto not_found;
+        return status;
+    }
+
     if ((fd = openat( root_fd, unix_name, O_RDONLY )) == -1) return errno_to_status( errno );
     if (!(dir = fdopendir( fd )))
     {
@@ -6251,6 +6440,39 @@ err:
 }
 
 
+/* fill an iovec array with the page buffers of a scatter/gather segment array */
+static int get_segments_iov( struct iovec *iov, const FILE_SEGMENT_ELEMENT *segments, UINT pos, ULONG length )
+{
+    int count;
+
+    for (count = 0; count < MAX_SEGMENT_IOV && length; count++, segments++, pos = 0)
+    {
+        iov[count].iov_base = (char *)segments->Buffer + pos;
+        iov[count].iov_len  = min( length, page_size - pos );
+        length -= iov[count].iov_len;
+    }
+    return count;
+}
+
+static ssize_t segments_pread( int fd, const struct iovec *iov, int count, off_t offset )
+{
+#ifdef HAVE_PREADV
+    return preadv( fd, iov, count, offset );
+#else
+    return pread( fd, iov[0].iov_base, iov[0].iov_len, offset );
+#endif
+}
+
+static ssize_t segments_pwrite( int fd, const struct iovec *iov, int count, off_t offset )
+{
+#ifdef HAVE_PWRITEV
+    return pwritev( fd, iov, count, offset );
+#else
+    return pwrite( fd, iov[0].iov_base, iov[0].iov_len, offset );
+#endif
+}
+
+
 /******************************************************************************
  *              NtReadFileScatter   (NTDLL.@)
  */
@@ -6284,11 +6506,13 @@ NTSTATUS WINAPI NtReadFileScatter( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
 
     while (length)
     {
+        struct iovec iov[MAX_SEGMENT_IOV];
+        int count = get_segments_iov( iov, segments, pos, length );
+
         if (offset && offset->QuadPart != FILE_USE_FILE_POINTER_POSITION)
-            result = pread( unix_handle, (char *)segments->Buffer + pos,
-                            min( length - pos, page_size - pos ), offset->QuadPart + total );
+            result = segments_pread( unix_handle, iov, count, offset->QuadPart + total );
         else
-            result = read( unix_handle, (char *)segments->Buffer + pos, min( length - pos, page_size - pos ) );
+            result = readv( unix_handle, iov, count );
 
         if (result == -1)
         {
@@ -6299,11 +6523,9 @@ NTSTATUS WINAPI NtReadFileScatter( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
         if (!result) break;
         total += result;
         length -= result;
-        if ((pos += result) == page_size)
-        {
-            pos = 0;
-            segments++;
-        }
+        pos += result;
+        segments += pos / page_size;
+        pos %= page_size;
     }
 
     if (total == 0) status = STATUS_END_OF_FILE;
@@ -6584,11 +6806,13 @@ NTSTATUS WINAPI NtWriteFileGather( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
 
     while (length)
     {
+        struct iovec iov[MAX_SEGMENT_IOV];
+        int count = get_segments_iov( iov, segments, pos, length );
+
         if (offset && offset->QuadPart != FILE_USE_FILE_POINTER_POSITION)
-            result = pwrite( unix_handle, (char *)segments->Buffer + pos,
-                             page_size - pos, offset->QuadPart + total );
+            result = segments_pwrite( unix_handle, iov, count, offset->QuadPart + total );
         else
-            result = write( unix_handle, (char *)segments->Buffer + pos, page_size - pos );
+            result = writev( unix_handle, iov, count );
 
         if (result == -1)
         {
@@ -6608,11 +6832,9 @@ NTSTATUS WINAPI NtWriteFileGather( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
         }
         total += result;
         length -= result;
-        if ((pos += result) == page_size)
-        {
-            pos = 0;
-            segments++;
-        }
+        pos += result;
+        segments += pos / page_size;
+        pos %= page_size;
     }
 
  done:
@@ -272,9 +272,28 @@ static void read_reply_data( int reply_fd, void *buffer, size_t size )
  */
 static inline unsigned int wait_reply( int reply_fd, struct __server_request_info *req )
 {
-    read_reply_data( reply_fd, &req->u.reply, sizeof(req->u.reply) );
-    if (req->u.reply.reply_header.reply_size)
-        read_reply_data( reply_fd, req->reply_data, req->u.reply.reply_header.reply_size );
+    struct iovec vec[2];
+    data_size_t size;
+    int ret;
+
+    /* receive the reply data along with the header when possible */
+    vec[0].iov_base = &req->u.reply;
+    vec[0].iov_len  = sizeof(req->u.reply);
+    vec[1].iov_base = req->reply_data;
+    vec[1].iov_len  = req->u.req.request_header.reply_size;
+
+    while ((ret = readv( reply_fd, vec, 2 )) < 0 && errno == EINTR);
+    if (ret < (int)sizeof(req->u.reply))
+    {
+        if (ret < 0 && errno != EPIPE) server_protocol_perror( "read" );
+        /* the server closed the connection; time to die... */
+        if (ret <= 0) abort_thread(0);
+        read_reply_data( reply_fd, (char *)&req->u.reply + ret, sizeof(req->u.reply) - ret );
+        ret = sizeof(req->u.reply);
+    }
+    size = ret - sizeof(req->u.reply);
+    if (req->u.reply.reply_header.reply_size > size)
+        read_reply_data( reply_fd, (char *)req->reply_data + size, req->u.reply.reply_header.reply_size - size );
     return req->u.reply.reply_header.error;
 }
 
@@ -43,6 +43,9 @@
 # include <netinet/tcp.h>
 #endif
 
+#ifdef linux
+# include <sys/sendfile.h>
+#endif
 #ifdef HAVE_NETIPX_IPX_H
 # include <netipx/ipx.h>
 # define HAS_IPX
@@ -133,6 +136,14 @@ struct async_send_ioctl
     struct iovec iov[1];
 };
 
+struct async_mmsg_ioctl
+{
+    struct async_fileio io;
+    struct afd_mmsg_params *params;
+    unsigned int count;
+    BOOL send;
+};
+
 struct async_transmit_ioctl
 {
     struct async_fileio io;
@@ -1353,6 +1364,244 @@ NTSTATUS sock_write( HANDLE handle, int fd, HANDLE event, PIO_APC_ROUTINE apc,
 }
 
 
+#ifndef HAVE_SENDMMSG
+struct mmsghdr
+{
+    struct msghdr msg_hdr;
+    unsigned int  msg_len;
+};
+#endif
+
+static int do_mmsg( int fd, struct mmsghdr *msgs, unsigned int count, BOOL send )
+{
+#ifdef HAVE_SENDMMSG
+    if (send) return sendmmsg( fd, msgs, count, 0 );
+    return recvmmsg( fd, msgs, count, 0, NULL );
+#else
+    unsigned int i;
+    ssize_t ret;
+
+    for (i = 0; i < count; ++i)
+    {
+        if (send) ret = sendmsg( fd, &msgs[i].msg_hdr, 0 );
+        else ret = recvmsg( fd, &msgs[i].msg_hdr, 0 );
+        if (ret < 0) return i ? i : -1;
+        msgs[i].msg_len = ret;
+    }
+    return count;
+#endif
+}
+
+/* transfer as many datagrams as possible without blocking, the status of
+ * the first one is returned if none of them could be transferred */
+static NTSTATUS try_mmsg( int fd, struct async_mmsg_ioctl *async, ULONG_PTR *size )
+{
+    unsigned int i, j, count = async->count, iov_count = 0;
+    union unix_sockaddr *addrs;
+    struct mmsghdr *msgs;
+    struct iovec *iov;
+    NTSTATUS status;
+    int ret, attempt = 0;
+
+    for (i = 0; i < count; ++i) iov_count += async->params[i].iov_count;
+    if (!(msgs = calloc( 1, count * (sizeof(*msgs) + sizeof(*addrs)) + iov_count * sizeof(*iov) )))
+        return STATUS_NO_MEMORY;
+    iov = (struct iovec *)(msgs + count);
+    addrs = (union unix_sockaddr *)(iov + iov_count);
+
+    for (i = 0; i < count; ++i)
+    {
+        const struct afd_mmsg_params *params = &async->params[i];
+        const struct afd_iovec *buffers = u64_to_user_ptr( params->iov_ptr );
+        struct msghdr *hdr = &msgs[i].msg_hdr;
+
+        hdr->msg_iov = iov;
+        hdr->msg_iovlen = params->iov_count;
+        for (j = 0; j < params->iov_count; ++j, ++iov)
+        {
+            iov->iov_base = u64_to_user_ptr( buffers[j].ptr );
+            iov->iov_len = buffers[j].len;
+        }
+
+        if (!params->addr_ptr) continue;
+        hdr->msg_name = &addrs[i];
+        if (!async->send)
+        {
+            hdr->msg_namelen = sizeof(addrs[i]);
+            continue;
+        }
+        if (!(hdr->msg_namelen = sockaddr_to_unix( u64_to_user_ptr( params->addr_ptr ), params->addr_len, &addrs[i] )))
+        {
+            /* send the previous messages, this one fails on its own */
+            if (!(count = i))
+            {
+                free( msgs );
+                return STATUS_INVALID_PARAMETER;
+            }
+            break;
+        }
+        /* see try_send() */
+        if ((addrs[i].addr.sa_family == AF_INET && !addrs[i].in.sin_port) ||
+            (addrs[i].addr.sa_family == AF_INET6 && !addrs[i].in6.sin6_port))
+            addrs[i].in.sin_port = htons( 9 );
+    }
+
+    for (;;)
+    {
+        if ((ret = do_mmsg( fd, msgs, count, async->send )) >= 0) break;
+        if (errno == EINTR) continue;
+        if (async->send && errno == EISCONN)
+        {
+            for (i = 0; i < count; ++i)
+            {
+                msgs[i].msg_hdr.msg_name = NULL;
+                msgs[i].msg_hdr.msg_namelen = 0;
+            }
+            continue;
+        }
+        if (async->send && errno == ECONNREFUSED && !attempt++) continue;
+        if (!async->send && errno == EFAULT)
+        {
+            /* the buffers may be write watched, receive a single message through the locked path */
+            ssize_t len = virtual_locked_recvmsg( fd, &msgs[0].msg_hdr, 0 );
+
+            if (len >= 0)
+            {
+                msgs[0].msg_len = len;
+                ret = 1;
+            }
+        }
+        break;
+    }
+
+    if (ret < 0)
+    {
+        status = sock_errno_to_status( errno );
+        if (status != STATUS_DEVICE_NOT_READY) WARN( "%s: %s\n", async->send ? "sendmmsg" : "recvmmsg", strerror( errno ) );
+        free( msgs );
+        return status;
+    }
+
+    for (i = 0; i < ret; ++i)
+    {
+        struct afd_mmsg_params *params = &async->params[i];
+        struct msghdr *hdr = &msgs[i].msg_hdr;
+
+        params->size = msgs[i].msg_len;
+        params->status = STATUS_SUCCESS;
+        if (async->send) continue;
+        if (hdr->msg_flags & MSG_TRUNC) params->status = STATUS_BUFFER_OVERFLOW;
+        if (params->addr_ptr && hdr->msg_namelen)
+            params->addr_len = sockaddr_from_unix( &addrs[i], u64_to_user_ptr( params->addr_ptr ), params->addr_len );
+    }
+    *size = ret;
+    free( msgs );
+    return STATUS_SUCCESS;
+}
+
+static BOOL async_mmsg_proc( void *user, ULONG_PTR *info, unsigned int *status )
+{
+    struct async_mmsg_ioctl *async = user;
+    int fd, needs_close;
+
+    TRACE( "%#x\n", *status );
+
+    if (*status == STATUS_ALERTED)
+    {
+        if ((*status = server_get_unix_fd( async->io.handle, 0, &fd, &needs_close, NULL, NULL )))
+            return TRUE;
+
+        *status = try_mmsg( fd, async, info );
+        TRACE( "got status %#x, %#lx messages transferred\n", *status, *info );
+        if (needs_close) close( fd );
+
+        if (*status == STATUS_DEVICE_NOT_READY)
+            return FALSE;
+    }
+    release_fileio( &async->io );
+    return TRUE;
+}
+
+/* transfer multiple datagrams with a single server call and system call,
+ * the request completes as soon as at least one of them was transferred */
+static NTSTATUS sock_ioctl_mmsg( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, void *apc_user,
+                                 IO_STATUS_BLOCK *io, int fd, struct afd_mmsg_params *params,
+                                 unsigned int count, BOOL send )
+{
+    struct async_mmsg_ioctl *async;
+    HANDLE wait_handle;
+    unsigned int i, j, status;
+    int sock_type;
+    socklen_t len = sizeof(sock_type);
+    ULONG options;
+
+    if (getsockopt( fd, SOL_SOCKET, SO_TYPE, &sock_type, &len ) || sock_type != SOCK_DGRAM)
+        return STATUS_NOT_SUPPORTED;
+
+    for (i = 0; i < count; ++i)
+    {
+        const struct afd_iovec *buffers = u64_to_user_ptr( params[i].iov_ptr );
+
+        if (params[i].iov_count > IOV_MAX) return STATUS_INVALID_PARAMETER;
+        for (j = 0; !send && j < params[i].iov_count; ++j)
+        {
+            if (!virtual_check_buffer_for_write( u64_to_user_ptr( buffers[j].ptr ), buffers[j].len ))
+                return STATUS_ACCESS_VIOLATION;
+        }
+    }
+
+    if (!(async = (struct async_mmsg_ioctl *)alloc_fileio( sizeof(*async), async_mmsg_proc, handle )))
+        return STATUS_NO_MEMORY;
+    async->params = params;
+    async->count = count;
+    async->send = send;
+
+    if (send)
+    {
+        SERVER_START_REQ( send_socket )
+        {
+            req->flags = SERVER_SOCKET_IO_FORCE_ASYNC;
+            req->async = server_async( handle, &async->io, event, apc, apc_user, iosb_client_ptr(io) );
+            status = wine_server_call( req );
+            wait_handle = wine_server_ptr_handle( reply->wait );
+            options     = reply->options;
+        }
+        SERVER_END_REQ;
+    }
+    else
+    {
+        SERVER_START_REQ( recv_socket )
+        {
+            req->force_async = 1;
+            req->async = server_async( handle, &async->io, event, apc, apc_user, iosb_client_ptr(io) );
+            req->oob   = 0;
+            status = wine_server_call( req );
+            wait_handle = wine_server_ptr_handle( reply->wait );
+            options     = reply->options;
+        }
+        SERVER_END_REQ;
+    }
+
+    /* the server currently will never succeed immediately */
+    assert(status == STATUS_ALERTED || status == STATUS_PENDING || NT_ERROR(status));
+
+    if (status == STATUS_ALERTED)
+    {
+        ULONG_PTR information = 0;
+
+        status = try_mmsg( fd, async, &information );
+        if (status == STATUS_DEVICE_NOT_READY) status = STATUS_PENDING;
+        set_async_direct_result( &wait_handle, options, io, status, information, FALSE );
+    }
+
+    if (status != STATUS_PENDING)
+        release_fileio( &async->io );
+
+    if (wait_handle) status = wait_async( wait_handle, options & FILE_SYNCHRONOUS_IO_ALERT );
+    return status;
+}
+
+
 static ssize_t do_send( int fd, const void *buffer, size_t len, int flags )
 {
     ssize_t ret;
@@ -1361,9 +1610,52 @@ static ssize_t do_send( int fd, const void *buffer, size_t len, int flags )
     return ret;
 }
 
+#ifdef linux
+/* send the file data directly from the file to the socket, without going through the buffer */
+static NTSTATUS try_sendfile( int sock_fd, int file_fd, struct async_transmit_ioctl *async )
+{
+    ssize_t ret;
+    off_t offset;
+    size_t size;
+
+    while (async->file)
+    {
+        size = 1u << 30;
+        if (async->file_len) size = min( size, async->file_len - async->file_cursor );
+
+        TRACE( "sending %zu bytes of file data with sendfile\n", size );
+        if (async->offset.QuadPart == FILE_USE_FILE_POINTER_POSITION)
+            ret = sendfile( sock_fd, file_fd, NULL, size );
+        else
+        {
+            offset = async->offset.QuadPart;
+            ret = sendfile( sock_fd, file_fd, &offset, size );
+        }
+        if (ret < 0)
+        {
+            if (errno == EINTR) continue;
+            /* let the caller fall back to read() and send() if sendfile isn't supported */
+            if (errno == EINVAL || errno == ENOSYS) return STATUS_NOT_SUPPORTED;
+            return sock_errno_to_status( errno );
+        }
+        TRACE( "sendfile returned %zd\n", ret );
+
+        async->file_cursor += ret;
+        if (async->offset.QuadPart != FILE_USE_FILE_POINTER_POSITION)
+            async->offset.QuadPart += ret;
+        if (!ret || (async->file_len && async->file_cursor == async->file_len))
+            async->file = NULL;
+    }
+    return STATUS_SUCCESS;
+}
+#endif
+
 static NTSTATUS try_transmit( int sock_fd, int file_fd, struct async_transmit_ioctl *async )
 {
     ssize_t ret;
+#ifdef linux
+    NTSTATUS status;
+#endif
 
     while (async->head_cursor < async->head_len)
     {
@@ -1386,6 +1678,14 @@ static NTSTATUS try_transmit( int sock_fd, int file_fd, struct async_transmit_io
         async->file_cursor += ret;
     }
 
+#ifdef linux
+    if (async->file && async->buffer_cursor == async->read_len)
+    {
+        status = try_sendfile( sock_fd, file_fd, async );
+        if (status && status != STATUS_NOT_SUPPORTED) return status;
+    }
+#endif
+
     if (async->file && async->buffer_cursor == async->read_len)
     {
         unsigned int read_size = async->buffer_size;
@@ -1810,6 +2110,23 @@ NTSTATUS sock_ioctl( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, void *apc
             return status;
         }
 
+        case IOCTL_AFD_WINE_RECVMMSG:
+        case IOCTL_AFD_WINE_SENDMMSG:
+        {
+            unsigned int count = in_size / sizeof(struct afd_mmsg_params);
+
+            if (!count || count > AFD_MAX_MMSG_COUNT || in_size % sizeof(struct afd_mmsg_params))
+                return STATUS_INVALID_PARAMETER;
+
+            if ((status = server_get_unix_fd( handle, 0, &fd, &needs_close, NULL, NULL )))
+                return status;
+
+            status = sock_ioctl_mmsg( handle, event, apc, apc_user, io, fd, in_buffer, count,
+                                      code == IOCTL_AFD_WINE_SENDMMSG );
+            if (needs_close) close( fd );
+            return status;
+        }
+
         case IOCTL_AFD_WINE_TRANSMIT:
         {
             const struct afd_transmit_params *params = in_buffer;
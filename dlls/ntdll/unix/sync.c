@@ -2871,9 +2871,10 @@ NTSTATUS WINAPI NtRemoveIoCompletion( HANDLE handle, ULONG_PTR *key, ULONG_PTR *
 NTSTATUS WINAPI NtRemoveIoCompletionEx( HANDLE handle, FILE_IO_COMPLETION_INFORMATION *info, ULONG count,
                                         ULONG *written, LARGE_INTEGER *timeout, BOOLEAN alertable )
 {
+    struct completion_info more[64];
     HANDLE wait_handle = NULL;
     unsigned int status;
-    ULONG i = 0;
+    ULONG i = 0, j, more_count;
 
     TRACE( "%p %p %u %p %p %u\n", handle, info, count, written, timeout, alertable );
 
@@ -2881,22 +2882,32 @@ NTSTATUS WINAPI NtRemoveIoCompletionEx( HANDLE handle, FILE_IO_COMPLETION_INFORM
 
     while (i < count)
     {
+        more_count = 0;
         SERVER_START_REQ( remove_completion )
         {
             req->handle = wine_server_obj_handle( handle );
             req->alertable = alertable;
+            wine_server_set_reply( req, more, min( count - i - 1, ARRAY_SIZE(more) ) * sizeof(*more) );
             if (!(status = wine_server_call( req )))
             {
                 info[i].CompletionKey             = reply->ckey;
                 info[i].CompletionValue           = reply->cvalue;
                 info[i].IoStatusBlock.Information = reply->information;
                 info[i].IoStatusBlock.Status      = reply->status;
+                more_count = wine_server_reply_size( reply ) / sizeof(*more);
             }
             else wait_handle = wine_server_ptr_handle( reply->wait_handle );
         }
         SERVER_END_REQ;
         if (status != STATUS_SUCCESS) break;
         ++i;
+        for (j = 0; j < more_count; j++, i++)
+        {
+            info[i].CompletionKey             = more[j].ckey;
+            info[i].CompletionValue           = more[j].cvalue;
+            info[i].IoStatusBlock.Information = more[j].information;
+            info[i].IoStatusBlock.Status      = more[j].status;
+        }
     }
     if (i || (status != STATUS_PENDING && status != STATUS_USER_APC))
     {
@@ -3030,11 +3030,12 @@ static IMAGE_BASE_RELOCATION *process_relocation_block( char *page, IMAGE_BASE_R
  *           map_image_into_view
  *
  * Map an executable (PE format) image into an existing view.
+ * If reloc_fd is valid, it contains the image already laid out and relocated to its map address.
  * virtual_mutex must be held by caller.
  */
 static NTSTATUS map_image_into_view( struct file_view *view, const UNICODE_STRING *nt_name, int fd,
                                      struct pe_image_info *image_info, USHORT machine,
-                                     int shared_fd, BOOL removable )
+                                     int shared_fd, int reloc_fd, BOOL removable )
 {
     IMAGE_DOS_HEADER *dos;
     IMAGE_NT_HEADERS *nt;
@@ -3052,6 +3053,13 @@ static NTSTATUS map_image_into_view( struct file_view *view, const UNICODE_STRIN
 
     TRACE_(module)( "mapping PE file %s at %p-%p\n", debugstr_us(nt_name), ptr, ptr + total_size );
 
+    if (reloc_fd != -1)
+    {
+        TRACE_(module)( "using relocated image for %s\n", debugstr_us(nt_name) );
+        fd = reloc_fd;
+        removable = FALSE;
+    }
+
     /* map the header */
 
     fstat( fd, &st );
@@ -3169,11 +3177,17 @@ static NTSTATUS map_image_into_view( struct file_view *view, const UNICODE_STRIN
 
         if (!sec[i].PointerToRawData || !file_size) continue;
 
+        if (reloc_fd != -1)  /* the relocated image is laid out by virtual address */
+        {
+            file_start = sec[i].VirtualAddress;
+            file_size = map_size;
+        }
+
         /* Note: if the section is not aligned properly map_file_into_view will magically
          *       fall back to read(), so we don't need to check anything here.
          */
         end = file_start + file_size;
-        if (sec[i].PointerToRawData >= st.st_size ||
+        if ((reloc_fd == -1 && sec[i].PointerToRawData >= st.st_size) ||
             end > ((st.st_size + sector_align) & ~sector_align) ||
             end < file_start ||
             map_file_into_view( view, fd, sec[i].VirtualAddress, file_size, file_start,
@@ -3219,7 +3233,7 @@ static NTSTATUS map_image_into_view( struct file_view *view, const UNICODE_STRIN
 
     /* relocate to dynamic base */
 
-    if (image_info->map_addr && (delta = image_info->map_addr - image_info->base))
+    if (reloc_fd == -1 && image_info->map_addr && (delta = image_info->map_addr - image_info->base))
     {
         TRACE_(module)( "relocating %s dynamic base %lx -> %lx mapped at %p\n", debugstr_us(nt_name),
                         (ULONG_PTR)image_info->base, (ULONG_PTR)image_info->map_addr, ptr );
@@ -3283,6 +3297,20 @@ static void free_pe_mapping_info( struct pe_mapping_info *info )
 }
 
 
+/***********************************************************************
+ *           advise_large_pages
+ *
+ * Ask the kernel to back a large page allocation with transparent huge pages.
+ */
+static void advise_large_pages( void *base, size_t size )
+{
+#ifdef MADV_HUGEPAGE
+    if (madvise( base, size, MADV_HUGEPAGE ))
+        WARN( "madvise(MADV_HUGEPAGE) failed for %p-%p: %s\n", base, (char *)base + size, strerror(errno) );
+#endif
+}
+
+
 /***********************************************************************
  *             get_mapping_info
  */
@@ -3405,6 +3433,8 @@ static NTSTATUS virtual_map_image( HANDLE mapping, void **addr_ptr, SIZE_T *size
 {
     int unix_fd = -1, needs_close;
     int shared_fd = -1, shared_needs_close = 0;
+    int reloc_fd = -1, reloc_needs_close = 0;
+    HANDLE reloc_file = 0;
     SIZE_T size = pe_mapping->image.map_size;
     struct file_view *view;
     unsigned int status;
@@ -3424,25 +3454,32 @@ static NTSTATUS virtual_map_image( HANDLE mapping, void **addr_ptr, SIZE_T *size
         return status;
     }
 
-    if (!pe_mapping->image.map_addr &&
+    if ((!pe_mapping->image.map_addr || pe_mapping->image.has_relocated) &&
         (pe_mapping->image.image_charact & IMAGE_FILE_DLL) &&
         (pe_mapping->image.image_flags & IMAGE_FLAGS_ImageDynamicallyRelocated))
     {
         SERVER_START_REQ( get_image_map_address )
         {
             req->handle = wine_server_obj_handle( mapping );
-            if (!wine_server_call( req )) pe_mapping->image.map_addr = reply->addr;
+            if (!wine_server_call( req ))
+            {
+                pe_mapping->image.map_addr = reply->addr;
+                reloc_file = wine_server_ptr_handle( reply->relocated_file );
+            }
         }
         SERVER_END_REQ;
     }
 
+    if (reloc_file && server_get_unix_fd( reloc_file, FILE_READ_DATA, &reloc_fd, &reloc_needs_close, NULL, NULL ))
+        reloc_fd = -1;
+
     server_enter_uninterrupted_section( &virtual_mutex, &sigset );
 
     status = map_image_view( &view, &pe_mapping->image, size, limit_low, limit_high, alloc_type );
     if (status) goto done;
 
     status = map_image_into_view( view, &pe_mapping->nt_name, unix_fd, &pe_mapping->image,
-                                  machine, shared_fd, needs_close );
+                                  machine, shared_fd, reloc_fd, needs_close );
     if (status == STATUS_SUCCESS)
     {
         if (offset)
@@ -3477,6 +3514,8 @@ done:
     server_leave_uninterrupted_section( &virtual_mutex, &sigset );
     if (needs_close) close( unix_fd );
     if (shared_needs_close) close( shared_fd );
+    if (reloc_needs_close) close( reloc_fd );
+    if (reloc_file) NtClose( reloc_file );
     return status;
 }
 
@@ -3589,6 +3628,7 @@ static unsigned int virtual_map_section( HANDLE handle, PVOID *addr_ptr, ULONG_P
     {
         /* file mappings must always be accessible */
         mprotect_range( view->base, view->size, VPROT_COMMITTED, 0 );
+        if (sec_flags & SEC_LARGE_PAGES) advise_large_pages( view->base, view->size );
 
         SERVER_START_REQ( map_view )
         {
@@ -5118,6 +5158,27 @@ void virtual_set_large_address_space(void)
 }
 
 
+/***********************************************************************
+ *           has_lock_memory_privilege
+ *
+ * Check whether the current thread holds SeLockMemoryPrivilege, which is
+ * required for large page allocations.
+ */
+static BOOL has_lock_memory_privilege(void)
+{
+    PRIVILEGE_SET privs;
+    BOOLEAN res = FALSE;
+
+    privs.PrivilegeCount = 1;
+    privs.Control = PRIVILEGE_SET_ALL_NECESSARY;
+    privs.Privilege[0].Luid.LowPart = SE_LOCK_MEMORY_PRIVILEGE;
+    privs.Privilege[0].Luid.HighPart = 0;
+    privs.Privilege[0].Attributes = 0;
+    if (NtPrivilegeCheck( GetCurrentThreadEffectiveToken(), &privs, &res )) return FALSE;
+    return res;
+}
+
+
 /***********************************************************************
  *             allocate_virtual_memory
  *
@@ -5178,8 +5239,11 @@ static NTSTATUS allocate_virtual_memory( void **ret, SIZE_T *size_ptr, ULONG typ
         break;
     case MEM_LARGE_PAGES:
         if (size & (user_shared_data->LargePageMinimum - 1)) return STATUS_INVALID_PARAMETER;
-        if (!(type & MEM_COMMIT)) return STATUS_INVALID_PARAMETER;
-        return STATUS_PRIVILEGE_NOT_HELD;
+        if ((type & (MEM_RESERVE | MEM_COMMIT)) != (MEM_RESERVE | MEM_COMMIT)) return STATUS_INVALID_PARAMETER;
+        if ((UINT_PTR)base & (user_shared_data->LargePageMinimum - 1)) return STATUS_INVALID_PARAMETER;
+        if (!has_lock_memory_privilege()) return STATUS_PRIVILEGE_NOT_HELD;
+        if (!align) align = user_shared_data->LargePageMinimum;
+        break;
     case MEM_PHYSICAL | MEM_LARGE_PAGES:
         if (size & granularity_mask) return STATUS_INVALID_PARAMETER;
         break;
@@ -5209,6 +5273,7 @@ static NTSTATUS allocate_virtual_memory( void **ret, SIZE_T *size_ptr, ULONG typ
             {
                 base = view->base;
                 if (vprot & VPROT_EXEC || force_exec_prot) mprotect_range( base, size, 0, 0 );
+                if (type & MEM_LARGE_PAGES) advise_large_pages( base, size );
             }
         }
     }
@@ -46,6 +46,10 @@ extern void set_gl_error( GLenum error );
 extern struct registry_entry *get_function_entry( const char *name );
 extern BOOL get_integer( GLenum pname, GLuint index, GLint value, GLint *data );
 extern void set_context_attribute( GLenum name, const void *value, size_t size );
+extern BOOL batch_gl_call( UINT code, const void *args, UINT size, const void *ptr, UINT ptr_size );
+extern void flush_gl_batch(void);
+extern void begin_gl_batch(void);
+extern BOOL end_gl_batch( const void *args, UINT size );
 
 enum object_type
 {
@@ -5040,6 +5040,59 @@ static void test_gl_error( HDC hdc )
     wglMakeCurrent( hdc, old_rc );
 }
 
+static void test_begin_end( HDC hdc )
+{
+    GLfloat color[4], current[4];
+    HGLRC rc, old_rc;
+    BOOL ret;
+    int i;
+
+    old_rc = wglGetCurrentContext();
+    rc = wglCreateContext( hdc );
+    ok( !!rc, "got %p\n", rc );
+    ret = wglMakeCurrent( hdc, rc );
+    ok( ret, "got %u\n", ret );
+
+    /* enough vertices to need more than a single batch */
+    glBegin( GL_POINTS );
+    for (i = 0; i < 10000; i++)
+    {
+        color[0] = (i % 256) / 255.0f;
+        color[1] = 0.25f;
+        color[2] = 0.5f;
+        color[3] = 1.0f;
+        glColor4fv( color );
+        color[1] = 0.75f;
+        glVertex3f( i / 10000.0f, 0.0f, 0.0f );
+    }
+    glEnd();
+    check_gl_error( GL_NO_ERROR );
+
+    glGetFloatv( GL_CURRENT_COLOR, current );
+    ok( current[0] == color[0], "got %f\n", current[0] );
+    ok( current[1] == 0.25f, "got %f\n", current[1] );
+    ok( current[2] == 0.5f, "got %f\n", current[2] );
+    ok( current[3] == 1.0f, "got %f\n", current[3] );
+
+    glColor3f( 1.0f, 0.0f, 0.0f );
+    glGetFloatv( GL_CURRENT_COLOR, current );
+    ok( current[0] == 1.0f && current[1] == 0.0f, "got %f,%f\n", current[0], current[1] );
+
+    glBegin( GL_TRIANGLES );
+    glColor3f( 0.0f, 1.0f, 0.0f );
+    glVertex2f( 0.0f, 0.0f );
+    glVertex2f( 1.0f, 0.0f );
+    glVertex2f( 0.0f, 1.0f );
+    glEnd();
+    glFinish();
+    check_gl_error( GL_NO_ERROR );
+    glGetFloatv( GL_CURRENT_COLOR, current );
+    ok( current[0] == 0.0f && current[1] == 1.0f, "got %f,%f\n", current[0], current[1] );
+
+    wglMakeCurrent( hdc, old_rc );
+    wglDeleteContext( rc );
+}
+
 static void test_memory_map( HDC hdc)
 {
     unsigned int i, major = 0, minor = 0;
@@ -5389,6 +5442,7 @@ START_TEST(opengl)
     test_framebuffer();
     test_memory_map( hdc );
     test_gl_error( hdc );
+    test_begin_end( hdc );
 
     tmp = ext.wglGetExtensionsStringEXT();
     ok( tmp && *tmp, "got wgl_extensions %s\n", debugstr_a(tmp) );
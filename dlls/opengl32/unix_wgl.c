@@ -1528,6 +1528,32 @@ NTSTATUS get_pixel_formats( void *args )
     return STATUS_SUCCESS;
 }
 
+static void replay_batch( const unixlib_entry_t *funcs, char *data, UINT size )
+{
+    char *ptr = data, *end = data + size;
+    struct batch_entry *entry;
+    NTSTATUS status;
+
+    while (ptr < end)
+    {
+        entry = (struct batch_entry *)ptr;
+        if (entry->code >= funcs_count || entry->size < sizeof(*entry) || entry->size > end - ptr)
+        {
+            ERR( "invalid batch entry %u, size %u\n", entry->code, entry->size );
+            return;
+        }
+        if ((status = funcs[entry->code]( entry + 1 ))) WARN( "batched call %u returned %#x\n", entry->code, status );
+        ptr += entry->size;
+    }
+}
+
+NTSTATUS flush_batch( void *args )
+{
+    struct flush_batch_params *params = args;
+    replay_batch( __wine_unix_call_funcs, params->data, params->size );
+    return STATUS_SUCCESS;
+}
+
 #ifdef _WIN64
 
 static pthread_mutex_t wgl_lock = PTHREAD_MUTEX_INITIALIZER;
@@ -2194,6 +2220,18 @@ NTSTATUS wow64_process_detach( void *args )
     return STATUS_SUCCESS;
 }
 
+NTSTATUS wow64_flush_batch( void *args )
+{
+    struct
+    {
+        PTR32 data;
+        UINT size;
+    } *params32 = args;
+
+    replay_batch( __wine_unix_call_wow64_funcs, ULongToPtr(params32->data), params32->size );
+    return STATUS_SUCCESS;
+}
+
 NTSTATUS wow64_get_pixel_formats( void *args )
 {
     struct
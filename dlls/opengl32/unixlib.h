@@ -25776,12 +25776,26 @@ struct get_pixel_formats_params
     unsigned int num_onscreen_formats;
 };
 
+struct flush_batch_params
+{
+    void *data;
+    UINT size;
+};
+
+/* header of each call recorded in a batch, followed by its params */
+struct batch_entry
+{
+    UINT32 code;
+    UINT32 size;
+};
+
 enum unix_funcs
 {
     unix_process_attach,
     unix_thread_attach,
     unix_process_detach,
     unix_get_pixel_formats,
+    unix_flush_batch,
     unix_wglDeleteContext,
     unix_wglGetPixelFormat,
     unix_wglSetPixelFormat,
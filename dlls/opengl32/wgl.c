@@ -46,6 +46,15 @@ static const MAT2 identity = { {0,1},{0,0},{0,0},{0,1} };
 #define WINE_GL_RESERVED_FORMATS_PTR      3
 #define WINE_GL_RESERVED_FORMATS_NUM      4
 #define WINE_GL_RESERVED_FORMATS_ONSCREEN 5
+#define WINE_GL_RESERVED_BATCH            6
+
+/* calls made between glBegin and glEnd, replayed with a single unix call */
+struct batch
+{
+    BOOL active;
+    UINT size;
+    UINT64 data[0x10000 / sizeof(UINT64)];
+};
 
 static CRITICAL_SECTION wgl_cs;
 static CRITICAL_SECTION_DEBUG wgl_cs_debug = {
@@ -915,6 +924,7 @@ void WINAPI glGetFramebufferAttachmentParameteriv( GLenum target, GLenum attachm
 
     TRACE( "target %d, attachment %d, pname %d, params %p\n", target, attachment, pname, params );
 
+    flush_gl_batch();
     if ((status = UNIX_CALL( glGetFramebufferAttachmentParameteriv, &args ))) WARN( "glGetFramebufferAttachmentParameteriv returned %#lx\n", status );
     map_framebuffer_attachment_param( target, attachment, pname, params );
 }
@@ -926,6 +936,7 @@ void WINAPI glGetFramebufferAttachmentParameterivEXT( GLenum target, GLenum atta
 
     TRACE( "target %d, attachment %d, pname %d, params %p\n", target, attachment, pname, params );
 
+    flush_gl_batch();
     if ((status = UNIX_CALL( glGetFramebufferAttachmentParameterivEXT, &args ))) WARN( "glGetFramebufferAttachmentParameterivEXT returned %#lx\n", status );
     map_framebuffer_attachment_param( target, attachment, pname, params );
 }
@@ -949,6 +960,7 @@ void WINAPI glGetNamedFramebufferAttachmentParameteriv( GLuint framebuffer, GLen
     TRACE( "framebuffer %d, attachment %d, pname %d, params %p\n", framebuffer, attachment, pname, params );
 
     args.framebuffer = *map_context_objects( OBJ_TYPE_FRAMEBUFFER, 1, &host_framebuffer );
+    flush_gl_batch();
     if ((status = UNIX_CALL( glGetNamedFramebufferAttachmentParameteriv, &args ))) WARN( "glGetNamedFramebufferAttachmentParameteriv returned %#lx\n", status );
     map_named_framebuffer_attachment_param( framebuffer, attachment, pname, params );
 }
@@ -963,6 +975,7 @@ void WINAPI glGetNamedFramebufferAttachmentParameterivEXT( GLuint framebuffer, G
 
     if (!alloc_context_objects( OBJ_TYPE_FRAMEBUFFER, 1, &host_framebuffer, TRUE )) return;
     args.framebuffer = *map_context_objects( OBJ_TYPE_FRAMEBUFFER, 1, &host_framebuffer );
+    flush_gl_batch();
     if ((status = UNIX_CALL( glGetNamedFramebufferAttachmentParameterivEXT, &args ))) WARN( "glGetNamedFramebufferAttachmentParameterivEXT returned %#lx\n", status );
     map_named_framebuffer_attachment_param( framebuffer, attachment, pname, params );
 }
@@ -1038,6 +1051,80 @@ BOOL WINAPI wglDeleteContext( HGLRC handle )
     return TRUE;
 }
 
+static struct batch *get_batch(void)
+{
+    return NtCurrentTeb()->glReserved1[WINE_GL_RESERVED_BATCH];
+}
+
+void flush_gl_batch(void)
+{
+    struct batch *batch = get_batch();
+    struct flush_batch_params args;
+    NTSTATUS status;
+
+    if (!batch || !batch->size) return;
+
+    args.data = batch->data;
+    args.size = batch->size;
+    batch->size = 0;
+    if ((status = UNIX_CALL( flush_batch, &args ))) WARN( "flush_batch returned %#lx\n", status );
+}
+
+BOOL batch_gl_call( UINT code, const void *args, UINT size, const void *ptr, UINT ptr_size )
+{
+    struct batch *batch = get_batch();
+    struct batch_entry *entry;
+    UINT entry_size;
+    char *params;
+
+    if (!batch || !batch->active) return FALSE;
+    if (ptr && !*(void *const *)ptr)
+    {
+        /* let the driver deal with it, but keep the calls ordered */
+        flush_gl_batch();
+        return FALSE;
+    }
+
+    entry_size = (sizeof(*entry) + size + ptr_size + 7) & ~7;
+    if (batch->size + entry_size > sizeof(batch->data)) flush_gl_batch();
+
+    entry = (struct batch_entry *)((char *)batch->data + batch->size);
+    entry->code = code;
+    entry->size = entry_size;
+    params = memcpy( entry + 1, args, size );
+    if (ptr)
+    {
+        /* the application may reuse the pointed data before the batch is flushed */
+        void **data = (void **)(params + ((const char *)ptr - (const char *)args));
+        *data = memcpy( params + size, *(void *const *)ptr, ptr_size );
+    }
+    batch->size += entry_size;
+    return TRUE;
+}
+
+void begin_gl_batch(void)
+{
+    PVOID *glReserved = NtCurrentTeb()->glReserved1;
+    struct batch *batch;
+
+    if (!(batch = glReserved[WINE_GL_RESERVED_BATCH]) &&
+        !(batch = glReserved[WINE_GL_RESERVED_BATCH] = calloc( 1, sizeof(*batch) )))
+        return;
+    batch->active = TRUE;
+}
+
+BOOL end_gl_batch( const void *args, UINT size )
+{
+    struct batch *batch = get_batch();
+
+    if (!batch || !batch->active) return FALSE;
+
+    batch_gl_call( unix_glEnd, args, size, NULL, 0 );
+    batch->active = FALSE;
+    flush_gl_batch();
+    return TRUE;
+}
+
 BOOL WINAPI wglMakeCurrent( HDC hdc, HGLRC handle )
 {
     TRACE( "hdc %p, handle %p\n", hdc, handle );
@@ -1054,6 +1141,7 @@ BOOL WINAPI wglMakeContextCurrentARB( HDC draw_hdc, HDC read_hdc, HGLRC handle )
     TEB *teb = NtCurrentTeb();
     struct wglMakeContextCurrentARB_params args = { .teb = teb, .hDrawDC = draw_hdc, .hReadDC = read_hdc };
     struct opengl_client_context *context = NULL, *previous = opengl_client_context_from_handle( teb->glCurrentRC );
+    struct batch *batch;
     NTSTATUS status;
 
     TRACE( "draw_hdc %p, read_hdc %p, handle %p\n", draw_hdc, read_hdc, handle );
@@ -1066,6 +1154,12 @@ BOOL WINAPI wglMakeContextCurrentARB( HDC draw_hdc, HDC read_hdc, HGLRC handle )
         return FALSE;
     }
 
+    if ((batch = get_batch()))
+    {
+        flush_gl_batch();
+        batch->active = FALSE;
+    }
+
     if ((status = UNIX_CALL( wglMakeContextCurrentARB, &args ))) WARN( "wglMakeContextCurrentARB returned %#lx\n", status );
     if (status || !args.ret) return FALSE;
 
@@ -2092,6 +2186,7 @@ BOOL WINAPI DECLSPEC_HOTPATCH wglSwapBuffers( HDC hdc )
     struct wglSwapBuffers_params args = { .teb = NtCurrentTeb(), .hdc = hdc };
     NTSTATUS status;
 
+    flush_gl_batch();
     if ((status = UNIX_CALL( wglSwapBuffers, &args ))) WARN( "wglSwapBuffers returned %#lx\n", status );
     else if (TRACE_ON(fps))
     {
@@ -2711,6 +2806,7 @@ GLhandleARB WINAPI glGetHandleARB( GLenum pname )
 
     TRACE( "pname %d\n", pname );
 
+    flush_gl_batch();
     if ((status = UNIX_CALL( glGetHandleARB, &args ))) WARN( "glGetHandleARB returned %#lx\n", status );
     if (!args.ret) return args.ret;
 
@@ -2735,6 +2831,7 @@ void WINAPI glGetAttachedObjectsARB( GLhandleARB container, GLsizei max_count, G
     TRACE( "container %d, max_count %d, count %p, obj %p\n", container, max_count, count, obj );
 
     args.containerObj = *map_context_objects( OBJ_TYPE_SHADER, 1, &container );
+    flush_gl_batch();
     if ((status = UNIX_CALL( glGetAttachedObjectsARB, &args ))) WARN( "glGetAttachedObjectsARB returned %#lx\n", status );
 
     if (!(ctx = context_from_handle( args.teb->glCurrentRC ))) return;
@@ -2760,6 +2857,7 @@ void WINAPI glGetAttachedShaders( GLuint program, GLsizei max_count, GLsizei *co
     TRACE( "program %d, max_count %d, count %p, shaders %p\n", program, max_count, count, shaders );
 
     args.program = *map_context_objects( OBJ_TYPE_SHADER, 1, &program );
+    flush_gl_batch();
     if ((status = UNIX_CALL( glGetAttachedShaders, &args ))) WARN( "glGetAttachedShaders returned %#lx\n", status );
 
     if (!(ctx = context_from_handle( args.teb->glCurrentRC ))) return;
@@ -2831,6 +2929,7 @@ GLsync WINAPI glCreateSyncFromCLeventARB( struct _cl_context *context, struct _c
     if (!(ptr = alloc_client_sync( ctx ))) return NULL;
     args.ret = ptr->user_data;
 
+    flush_gl_batch();
     if ((status = UNIX_CALL( glCreateSyncFromCLeventARB, &args ))) WARN( "glCreateSyncFromCLeventARB returned %#lx\n", status );
     assert( args.ret == ptr->user_data || !args.ret );
 
@@ -2853,6 +2952,7 @@ void WINAPI glDeleteSync( GLsync sync )
     if (!(ptr = get_handle_ptr( &ctx->lists->syncs, sync ))) return set_gl_error( GL_INVALID_VALUE );
     args.sync = ptr->user_data;
 
+    flush_gl_batch();
     if ((status = UNIX_CALL( glDeleteSync, &args ))) WARN( "glDeleteSync returned %#lx\n", status );
     if (!status) free_client_sync( ctx, ptr );
 }
@@ -2871,6 +2971,7 @@ GLsync WINAPI glFenceSync( GLenum condition, GLbitfield flags )
     if (!(ptr = alloc_client_sync( ctx ))) return NULL;
     args.ret = ptr->user_data;
 
+    flush_gl_batch();
     if ((status = UNIX_CALL( glFenceSync, &args ))) WARN( "glFenceSync returned %#lx\n", status );
     assert( args.ret == ptr->user_data || !args.ret );
 
@@ -2893,6 +2994,7 @@ GLsync WINAPI glImportSyncEXT( GLenum external_sync_type, GLintptr external_sync
     if (!(ptr = alloc_client_sync( ctx ))) return NULL;
     args.ret = ptr->user_data;
 
+    flush_gl_batch();
     if ((status = UNIX_CALL( glImportSyncEXT, &args ))) WARN( "glImportSyncEXT returned %#lx\n", status );
     assert( args.ret == ptr->user_data || !args.ret );
 
@@ -2956,6 +3058,7 @@ const GLubyte * WINAPI glGetStringi( GLenum name, GLuint index )
         return NULL;
     }
 
+    flush_gl_batch();
 #ifndef _WIN64
     if (UNIX_CALL( glGetStringi, &args ) == STATUS_BUFFER_TOO_SMALL) args.ret = wow64_str = malloc( (size_t)args.ret );
 #endif
@@ -2990,6 +3093,7 @@ const GLubyte * WINAPI glGetString( GLenum name )
     case GL_VERSION: return (const GLubyte *)ctx->base.version_str;
     }
 
+    flush_gl_batch();
 #ifndef _WIN64
     if (UNIX_CALL( glGetString, &args ) == STATUS_BUFFER_TOO_SMALL) args.ret = wow64_str = malloc( (size_t)args.ret );
 #endif
@@ -3115,6 +3219,7 @@ BOOL WINAPI DllMain( HINSTANCE hinst, DWORD reason, LPVOID reserved )
     case DLL_THREAD_DETACH:
         if ((context = get_current_context())) context->base.current_tid = 0;
         free( NtCurrentTeb()->glReserved1[WINE_GL_RESERVED_FORMATS_PTR] );
+        free( NtCurrentTeb()->glReserved1[WINE_GL_RESERVED_BATCH] );
         return TRUE;
     }
     return TRUE;
@@ -585,17 +585,37 @@ static void mask_rect( dib_info *dst, const RECT *dst_rect, const dib_info *src,
     }
 }
 
+struct blend_rects_params
+{
+    const dib_info *dst;
+    const dib_info *src;
+    POINT           offset;
+    BLENDFUNCTION   blend;
+};
+
+static BOOL blend_rects_band( void *ctx, int num, const RECT *rects )
+{
+    const struct blend_rects_params *params = ctx;
+
+    params->dst->funcs->blend_rects( params->dst, num, rects, params->src, &params->offset, params->blend );
+    return TRUE;
+}
+
 static DWORD blend_rect( dib_info *dst, const RECT *dst_rect, const dib_info *src, const RECT *src_rect,
                          HRGN clip, BLENDFUNCTION blend )
 {
-    POINT offset;
+    struct blend_rects_params params = { dst, src, { 0, 0 }, blend };
     struct clipped_rects clipped_rects;
 
     if (!get_clipped_rects( dst, dst_rect, clip, &clipped_rects )) return ERROR_SUCCESS;
 
-    offset.x = src_rect->left - dst_rect->left;
-    offset.y = src_rect->top  - dst_rect->top;
-    dst->funcs->blend_rects( dst, clipped_rects.count, clipped_rects.rects, src, &offset, blend );
+    params.offset.x = src_rect->left - dst_rect->left;
+    params.offset.y = src_rect->top  - dst_rect->top;
+    /* rows may depend on previously blended ones when blending a dib onto itself */
+    if (src->bits.ptr == dst->bits.ptr)
+        blend_rects_band( &params, clipped_rects.count, clipped_rects.rects );
+    else
+        render_in_bands( dst, src, clipped_rects.count, clipped_rects.rects, blend_rects_band, &params );
 
     free_clipped_rects( &clipped_rects );
     return ERROR_SUCCESS;
@@ -680,17 +700,31 @@ static void get_gradient_triangle_vertices( const GRADIENT_TRIANGLE *tri, const
     bounds->bottom = v[2].y;
 }
 
-static BOOL gradient_rect( dib_info *dib, TRIVERTEX *v, int mode, HRGN clip, const RECT *bounds )
+struct gradient_rect_params
+{
+    const dib_info  *dib;
+    const TRIVERTEX *v;
+    int              mode;
+};
+
+static BOOL gradient_rect_band( void *ctx, int num, const RECT *rects )
 {
+    const struct gradient_rect_params *params = ctx;
     int i;
+
+    for (i = 0; i < num; i++)
+        if (!params->dib->funcs->gradient_rect( params->dib, &rects[i], params->v, params->mode )) return FALSE;
+    return TRUE;
+}
+
+static BOOL gradient_rect( dib_info *dib, TRIVERTEX *v, int mode, HRGN clip, const RECT *bounds )
+{
+    struct gradient_rect_params params = { dib, v, mode };
     struct clipped_rects clipped_rects;
-    BOOL ret = TRUE;
+    BOOL ret;
 
     if (!get_clipped_rects( dib, bounds, clip, &clipped_rects )) return TRUE;
-    for (i = 0; i < clipped_rects.count; i++)
-    {
-        if (!(ret = dib->funcs->gradient_rect( dib, &clipped_rects.rects[i], v, mode ))) break;
-    }
+    ret = render_in_bands( dib, NULL, clipped_rects.count, clipped_rects.rects, gradient_rect_band, &params );
     free_clipped_rects( &clipped_rects );
     return ret;
 }
@@ -23,6 +23,7 @@
 #endif
 
 #include <assert.h>
+#include <pthread.h>
 
 #include "ntgdi_private.h"
 #include "dibdrv.h"
@@ -88,6 +89,7 @@ static void init_dib_info(dib_info *dib, const BITMAPINFOHEADER *bi, int stride,
     dib->bits.is_copy = FALSE;
     dib->bits.free    = NULL;
     dib->bits.param   = NULL;
+    dib->private_bits = FALSE;
 
     if(dib->height < 0) /* top-down */
     {
@@ -174,6 +176,7 @@ BOOL init_dib_info_from_bitmapobj(dib_info *dib, BITMAPOBJ *bmp)
 
         get_ddb_bitmapinfo( bmp, &info );
         init_dib_info_from_bitmapinfo( dib, &info, bmp->dib.dsBm.bmBits );
+        dib->private_bits = TRUE;
     }
     else init_dib_info( dib, &bmp->dib.dsBmih, bmp->dib.dsBm.bmWidthBytes,
                         bmp->dib.dsBitfields, bmp->color_table, bmp->dib.dsBm.bmBits );
@@ -299,6 +302,160 @@ int get_clipped_rects( const dib_info *dib, const RECT *rc, HRGN clip, struct cl
     return clip_rects->count;
 }
 
+/* large operations are split into horizontal bands that are rendered in parallel */
+#define MAX_DIB_BANDS    8
+#define MIN_BAND_PIXELS  (512 * 1024)
+
+struct dib_band
+{
+    band_func   func;
+    void       *ctx;
+    int         num;
+    RECT       *rects;
+    BOOL        ret;
+};
+
+static pthread_mutex_t band_submit_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t band_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t band_start_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t band_done_cond = PTHREAD_COND_INITIALIZER;
+static pthread_once_t band_init_once = PTHREAD_ONCE_INIT;
+static struct dib_band bands[MAX_DIB_BANDS];
+static int band_count, band_next, band_pending;
+static int band_threads;  /* number of threads rendering bands, including the caller */
+
+/* the band threads are plain pthreads without a TEB, so they can't handle faults on app memory */
+static BOOL is_private_dib( const dib_info *dib )
+{
+    return dib->private_bits || dib->bits.is_copy;
+}
+
+/* grab the next band and render it, returns with band_mutex held */
+static BOOL render_next_band(void)
+{
+    struct dib_band *band;
+
+    if (band_next >= band_count) return FALSE;
+    band = &bands[band_next++];
+    pthread_mutex_unlock( &band_mutex );
+    band->ret = band->func( band->ctx, band->num, band->rects );
+    pthread_mutex_lock( &band_mutex );
+    if (!--band_pending) pthread_cond_signal( &band_done_cond );
+    return TRUE;
+}
+
+static void *band_thread( void *arg )
+{
+    pthread_mutex_lock( &band_mutex );
+    for (;;)
+    {
+        if (!render_next_band()) pthread_cond_wait( &band_start_cond, &band_mutex );
+    }
+    return NULL;
+}
+
+static BOOL get_band_rendering_option(void)
+{
+    char buffer[offsetof(KEY_VALUE_PARTIAL_INFORMATION, Data[8 * sizeof(WCHAR)])];
+    KEY_VALUE_PARTIAL_INFORMATION *info = (void *)buffer;
+    BOOL ret = FALSE;
+    HKEY hkey;
+
+    /* @@ Wine registry key: HKCU\Software\Wine\Gdi */
+    if ((hkey = reg_open_hkcu_key( "Software\\Wine\\Gdi" )))
+    {
+        if (query_reg_ascii_value( hkey, "ParallelRendering", info, sizeof(buffer) ) && info->Type == REG_SZ)
+        {
+            static const WCHAR valsW[] = {'y','Y','t','T','1',0};
+            ret = (wcschr( valsW, *(const WCHAR *)info->Data ) != NULL);
+        }
+        NtClose( hkey );
+    }
+    return ret;
+}
+
+static void init_band_threads(void)
+{
+    int i, count = min( system_info.NumberOfProcessors, MAX_DIB_BANDS );
+    pthread_attr_t attr;
+    pthread_t thread;
+
+    band_threads = 1;
+    if (!get_band_rendering_option()) return;
+
+    pthread_attr_init( &attr );
+    pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+    for (i = 1; i < count; i++, band_threads++)
+        if (pthread_create( &thread, &attr, band_thread, NULL )) break;
+    pthread_attr_destroy( &attr );
+    TRACE( "using %u threads\n", band_threads );
+}
+
+/***********************************************************************
+ *           render_in_bands
+ *
+ * Call func for a list of disjoint rectangles, splitting them into horizontal
+ * bands rendered in parallel if the area is large enough, parallel rendering is
+ * enabled, and the destination and source bits belong to win32u. func must only
+ * touch pixels inside the rectangles it is given.
+ */
+BOOL render_in_bands( const dib_info *dst, const dib_info *src, int num, const RECT *rects,
+                      band_func func, void *ctx )
+{
+    RECT *band_rects, *out;
+    int i, j, top = INT_MAX, bottom = INT_MIN, height, count;
+    UINT64 area = 0;
+    BOOL ret = TRUE;
+
+    for (i = 0; i < num; i++)
+    {
+        area += (UINT64)(rects[i].right - rects[i].left) * (rects[i].bottom - rects[i].top);
+        top = min( top, rects[i].top );
+        bottom = max( bottom, rects[i].bottom );
+    }
+    if (area < 2 * MIN_BAND_PIXELS) return func( ctx, num, rects );
+    if (!is_private_dib( dst ) || (src && !is_private_dib( src ))) return func( ctx, num, rects );
+
+    pthread_once( &band_init_once, init_band_threads );
+    count = min( band_threads, area / MIN_BAND_PIXELS );
+    count = min( count, bottom - top );
+    if (count < 2) return func( ctx, num, rects );
+
+    /* only one banded operation at a time, others render on their own thread */
+    if (pthread_mutex_trylock( &band_submit_mutex )) return func( ctx, num, rects );
+    if (!(band_rects = malloc( count * num * sizeof(*band_rects) )))
+    {
+        pthread_mutex_unlock( &band_submit_mutex );
+        return func( ctx, num, rects );
+    }
+
+    height = bottom - top;
+    for (i = 0, out = band_rects; i < count; i++)
+    {
+        RECT band = { INT_MIN, top + height * i / count, INT_MAX, top + height * (i + 1) / count };
+
+        bands[i].func  = func;
+        bands[i].ctx   = ctx;
+        bands[i].rects = out;
+        for (j = 0; j < num; j++) if (intersect_rect( out, &rects[j], &band )) out++;
+        bands[i].num = out - bands[i].rects;
+    }
+
+    pthread_mutex_lock( &band_mutex );
+    band_count = band_pending = count;
+    band_next = 0;
+    pthread_cond_broadcast( &band_start_cond );
+    while (render_next_band()) ;
+    while (band_pending) pthread_cond_wait( &band_done_cond, &band_mutex );
+    band_count = 0;
+    pthread_mutex_unlock( &band_mutex );
+
+    for (i = 0; i < count; i++) ret = ret && bands[i].ret;
+    pthread_mutex_unlock( &band_submit_mutex );
+    free( band_rects );
+    return ret;
+}
+
 void add_clipped_bounds( dibdrv_physdev *dev, const RECT *rect, HRGN clip )
 {
     const WINEREGION *region;
@@ -597,6 +754,7 @@ void dibdrv_set_window_surface( DC *dc, struct window_surface *surface )
             init_dib_info_from_bitmapobj( &dibdrv->dib, bmp );
             GDI_ReleaseObj( surface->color_bitmap );
         }
+        dibdrv->dib.private_bits = TRUE;  /* window surfaces are never exposed to the app */
         dibdrv->dib.rect = dc->attr->vis_rect;
         OffsetRect( &dibdrv->dib.rect, -dc->device_rect.left, -dc->device_rect.top );
         dibdrv->bounds = &surface->bounds;
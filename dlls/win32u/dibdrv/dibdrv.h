@@ -25,6 +25,7 @@ typedef struct
     RECT rect;  /* visible rectangle relative to bitmap origin */
     int stride; /* stride in bytes.  Will be -ve for bottom-up dibs (see bits). */
     struct gdi_image_bits bits; /* bits.ptr points to the top-left corner of the dib. */
+    BOOL private_bits;          /* bits are allocated by win32u and not accessible to the app */
 
     DWORD red_mask, green_mask, blue_mask;
     int red_shift, green_shift, blue_shift;
@@ -260,9 +261,13 @@ extern int get_dib_rect( const dib_info *dib, RECT *rc );
 extern int clip_rect_to_dib( const dib_info *dib, RECT *rc );
 extern int get_clipped_rects( const dib_info *dib, const RECT *rc, HRGN clip, struct clipped_rects *clip_rects );
 extern void add_clipped_bounds( dibdrv_physdev *dev, const RECT *rect, HRGN clip );
+typedef BOOL (*band_func)( void *ctx, int num, const RECT *rects );
+extern BOOL render_in_bands( const dib_info *dst, const dib_info *src, int num, const RECT *rects,
+                             band_func func, void *ctx );
 extern int clip_line(const POINT *start, const POINT *end, const RECT *clip,
                      const bres_params *params, POINT *pt1, POINT *pt2);
 extern void release_cached_font( struct cached_font *font );
+extern void fill_solid_rects( const dib_info *dib, int num, const RECT *rects, DWORD and, DWORD xor );
 extern BOOL fill_with_pixel( DC *dc, dib_info *dib, DWORD pixel, int num, const RECT *rects, INT rop );
 
 static inline void init_clipped_rects( struct clipped_rects *clip_rects )
@@ -1785,6 +1785,33 @@ COLORREF dibdrv_SetDCPenColor( PHYSDEV dev, COLORREF color )
     return color;
 }
 
+struct solid_rects_params
+{
+    const dib_info *dib;
+    DWORD           and;
+    DWORD           xor;
+};
+
+static BOOL solid_rects_band( void *ctx, int num, const RECT *rects )
+{
+    const struct solid_rects_params *params = ctx;
+
+    params->dib->funcs->solid_rects( params->dib, num, rects, params->and, params->xor );
+    return TRUE;
+}
+
+/**********************************************************************
+ *             fill_solid_rects
+ *
+ * Fill a number of rectangles with the given and/xor masks
+ */
+void fill_solid_rects( const dib_info *dib, int num, const RECT *rects, DWORD and, DWORD xor )
+{
+    struct solid_rects_params params = { dib, and, xor };
+
+    render_in_bands( dib, NULL, num, rects, solid_rects_band, &params );
+}
+
 /**********************************************************************
  *             fill_with_pixel
  *
@@ -1795,7 +1822,7 @@ BOOL fill_with_pixel( DC *dc, dib_info *dib, DWORD pixel, int num, const RECT *r
     rop_mask mask;
 
     calc_rop_masks( rop, pixel, &mask );
-    dib->funcs->solid_rects( dib, num, rects, mask.and, mask.xor );
+    fill_solid_rects( dib, num, rects, mask.and, mask.xor );
     return TRUE;
 }
 
@@ -2030,6 +2057,22 @@ static BOOL select_pattern_brush( dibdrv_physdev *pdev, dib_brush *brush, BOOL *
     return TRUE;
 }
 
+struct pattern_rects_params
+{
+    const dib_info  *dib;
+    const POINT     *origin;
+    const dib_brush *brush;
+};
+
+static BOOL pattern_rects_band( void *ctx, int num, const RECT *rects )
+{
+    const struct pattern_rects_params *params = ctx;
+
+    params->dib->funcs->pattern_rects( params->dib, num, rects, params->origin,
+                                       &params->brush->dib, &params->brush->masks );
+    return TRUE;
+}
+
 /**********************************************************************
  *             pattern_brush
  *
@@ -2039,6 +2082,7 @@ static BOOL select_pattern_brush( dibdrv_physdev *pdev, dib_brush *brush, BOOL *
 static BOOL pattern_brush(dibdrv_physdev *pdev, dib_brush *brush, dib_info *dib,
                           int num, const RECT *rects, const POINT *brush_org, INT rop)
 {
+    struct pattern_rects_params params;
     BOOL needs_reselect = FALSE;
 
     if (rop != brush->rop)
@@ -2074,7 +2118,11 @@ static BOOL pattern_brush(dibdrv_physdev *pdev, dib_brush *brush, dib_info *dib,
         }
     }
 
-    dib->funcs->pattern_rects( dib, num, rects, brush_org, &brush->dib, &brush->masks );
+    params.dib    = dib;
+    params.origin = brush_org;
+    params.brush  = brush;
+    /* the pattern bits are always a copy owned by the brush */
+    render_in_bands( dib, NULL, num, rects, pattern_rects_band, &params );
 
     if (needs_reselect) free_pattern_brush( brush );
     return TRUE;
@@ -23,6 +23,9 @@
 #endif
 
 #include <assert.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "ntgdi_private.h"
 #include "dibdrv.h"
@@ -4664,6 +4667,80 @@ static inline DWORD blend_argb_alpha( DWORD dst, DWORD src, DWORD alpha )
             (alpha + ((BYTE)(dst >> 24) * (255 - alpha) + 127) / 255) << 24);
 }
 
+#ifdef __SSE2__
+
+/* (x + 127) / 255 for 0 <= x <= 255 * 255 */
+static inline __m128i div255_epi16( __m128i x )
+{
+    x = _mm_add_epi16( x, _mm_set1_epi16( 128 ));
+    return _mm_srli_epi16( _mm_add_epi16( x, _mm_srli_epi16( x, 8 )), 8 );
+}
+
+/* blend two unpacked pixels, src + dst * (255 - src alpha) / 255 */
+static inline __m128i blend_argb_epi16( __m128i dst, __m128i src )
+{
+    __m128i alpha = _mm_shufflehi_epi16( _mm_shufflelo_epi16( src, 0xff ), 0xff );
+    __m128i inv = _mm_sub_epi16( _mm_set1_epi16( 255 ), alpha );
+
+    return _mm_add_epi16( src, div255_epi16( _mm_mullo_epi16( dst, inv )));
+}
+
+/* blend 4 pixels at once; fails if the source isn't premultiplied and a channel
+ * overflows, since the scalar code then carries into the next channel */
+static inline BOOL blend_argb_4( DWORD *dst, const DWORD *src, DWORD alpha, __m128i alpha_vec )
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i s = _mm_loadu_si128( (const __m128i *)src );
+    __m128i d = _mm_loadu_si128( (const __m128i *)dst );
+    __m128i s_lo = _mm_unpacklo_epi8( s, zero ), s_hi = _mm_unpackhi_epi8( s, zero );
+    __m128i lo, hi;
+
+    if (alpha != 255)
+    {
+        s_lo = div255_epi16( _mm_mullo_epi16( s_lo, alpha_vec ));
+        s_hi = div255_epi16( _mm_mullo_epi16( s_hi, alpha_vec ));
+    }
+    lo = blend_argb_epi16( _mm_unpacklo_epi8( d, zero ), s_lo );
+    hi = blend_argb_epi16( _mm_unpackhi_epi8( d, zero ), s_hi );
+    if (_mm_movemask_epi8( _mm_cmpgt_epi16( _mm_or_si128( lo, hi ), _mm_set1_epi16( 255 )))) return FALSE;
+    _mm_storeu_si128( (__m128i *)dst, _mm_packus_epi16( lo, hi ));
+    return TRUE;
+}
+
+#endif
+
+static void blend_argb_row( DWORD *dst, const DWORD *src, int len, DWORD alpha )
+{
+    int x = 0;
+
+#ifdef __SSE2__
+    __m128i alpha_vec = _mm_set1_epi16( alpha );
+
+    for (; x <= len - 4; x += 4)
+    {
+        if (blend_argb_4( dst + x, src + x, alpha, alpha_vec )) continue;
+        if (alpha == 255)
+        {
+            dst[x]     = blend_argb( dst[x], src[x] );
+            dst[x + 1] = blend_argb( dst[x + 1], src[x + 1] );
+            dst[x + 2] = blend_argb( dst[x + 2], src[x + 2] );
+            dst[x + 3] = blend_argb( dst[x + 3], src[x + 3] );
+        }
+        else
+        {
+            dst[x]     = blend_argb_alpha( dst[x], src[x], alpha );
+            dst[x + 1] = blend_argb_alpha( dst[x + 1], src[x + 1], alpha );
+            dst[x + 2] = blend_argb_alpha( dst[x + 2], src[x + 2], alpha );
+            dst[x + 3] = blend_argb_alpha( dst[x + 3], src[x + 3], alpha );
+        }
+    }
+#endif
+    if (alpha == 255)
+        for (; x < len; x++) dst[x] = blend_argb( dst[x], src[x] );
+    else
+        for (; x < len; x++) dst[x] = blend_argb_alpha( dst[x], src[x], alpha );
+}
+
 static inline DWORD blend_rgb( BYTE dst_r, BYTE dst_g, BYTE dst_b, DWORD src, BLENDFUNCTION blend )
 {
     if (blend.AlphaFormat & AC_SRC_ALPHA)
@@ -4693,16 +4770,8 @@ static void blend_rects_8888(const dib_info *dst, int num, const RECT *rc,
         DWORD *dst_ptr = get_pixel_ptr_32( dst, rc->left, rc->top );
 
         if (blend.AlphaFormat & AC_SRC_ALPHA)
-        {
-            if (blend.SourceConstantAlpha == 255)
-                for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-                    for (x = 0; x < rc->right - rc->left; x++)
-                        dst_ptr[x] = blend_argb( dst_ptr[x], src_ptr[x] );
-            else
-                for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-                    for (x = 0; x < rc->right - rc->left; x++)
-                        dst_ptr[x] = blend_argb_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
-        }
+            for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
+                blend_argb_row( dst_ptr, src_ptr, rc->right - rc->left, blend.SourceConstantAlpha );
         else if (src->compression == BI_RGB)
             for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
                 for (x = 0; x < rc->right - rc->left; x++)
@@ -30,6 +30,7 @@
 #include <string.h>
 #include <assert.h>
 #include <pthread.h>
+#include <sys/stat.h>
 
 #include "ntstatus.h"
 #include "winerror.h"
@@ -1206,6 +1207,288 @@ static struct gdi_font_face *create_face( struct gdi_font_family *family, const
     return NULL;
 }
 
+/* system font index
+ *
+ * Loading the fonts found by the backend means opening every font file, so the
+ * first process of a session records the resulting faces, along with the
+ * status of the font files, of the directories they were found in, and of the
+ * backend configuration files. Later processes replay the faces from the
+ * volatile cache key, unless one of these paths changed.
+ */
+
+#define FONT_INDEX_VERSION  2
+
+enum font_index_type
+{
+    FONT_INDEX_PATH,
+    FONT_INDEX_FACE,
+};
+
+struct font_index_record
+{
+    DWORD type;
+    DWORD len;  /* total size of the record, aligned */
+};
+
+struct font_index_path
+{
+    struct font_index_record hdr;
+    ULONGLONG                mtime;  /* in nanoseconds */
+    ULONGLONG                size;
+    ULONGLONG                inode;
+    char                     path[1];
+};
+
+struct font_index_face
+{
+    struct font_index_record hdr;
+    DWORD                    index;
+    DWORD                    flags;
+    DWORD                    ntmflags;
+    DWORD                    weight;
+    DWORD                    version;
+    FONTSIGNATURE            fs;
+    struct bitmap_font_size  size;
+    BOOL                     scalable;
+    DWORD                    null_names;  /* mask of names that were NULL */
+    WCHAR                    names[1];    /* family, second, style, full and file names */
+};
+
+static const WCHAR font_indexW[] = {'S','y','s','t','e','m','I','n','d','e','x',0};
+
+static struct
+{
+    BYTE  *data;
+    SIZE_T size;
+    SIZE_T max_size;
+    DWORD  path_count;
+} font_index;
+
+static void *add_font_index_record( DWORD type, SIZE_T len )
+{
+    struct font_index_record *record;
+
+    len = (len + 7) & ~7;
+    if (!font_index.data) return NULL;
+    if (font_index.size + len > font_index.max_size)
+    {
+        SIZE_T new_size = max( font_index.max_size * 2, font_index.size + len );
+        BYTE *new_data;
+
+        if (!(new_data = realloc( font_index.data, new_size )))
+        {
+            free( font_index.data );
+            font_index.data = NULL;
+            return NULL;
+        }
+        font_index.data = new_data;
+        font_index.max_size = new_size;
+    }
+    record = (struct font_index_record *)(font_index.data + font_index.size);
+    memset( record, 0, len );
+    record->type = type;
+    record->len  = len;
+    font_index.size += len;
+    return record;
+}
+
+static void get_index_path_status( const char *path, ULONGLONG *mtime, ULONGLONG *size, ULONGLONG *inode )
+{
+    struct stat st;
+
+    *mtime = *size = *inode = 0;
+    if (stat( path, &st )) return;
+    /* files written within the same second must be told apart */
+    *mtime = (ULONGLONG)st.st_mtime * 1000000000;
+#ifdef HAVE_STRUCT_STAT_ST_MTIM
+    *mtime += st.st_mtim.tv_nsec;
+#elif defined(HAVE_STRUCT_STAT_ST_MTIMESPEC)
+    *mtime += st.st_mtimespec.tv_nsec;
+#endif
+    *size = st.st_size;
+    *inode = st.st_ino;
+}
+
+/* called by the font backend for each font file, font directory and configuration file it used */
+void add_font_index_path( const char *unix_path )
+{
+    struct font_index_path *path;
+    SIZE_T len = strlen( unix_path ) + 1;
+
+    if (!(path = add_font_index_record( FONT_INDEX_PATH, offsetof( struct font_index_path, path[len] ))))
+        return;
+    get_index_path_status( unix_path, &path->mtime, &path->size, &path->inode );
+    memcpy( path->path, unix_path, len );
+    font_index.path_count++;
+}
+
+static WCHAR *put_index_name( struct font_index_face *face, WCHAR *ptr, const WCHAR *name, int i )
+{
+    SIZE_T len = name ? lstrlenW( name ) : 0;
+
+    if (!name) face->null_names |= 1 << i;
+    if (len) memcpy( ptr, name, len * sizeof(WCHAR) );
+    ptr[len] = 0;
+    return ptr + len + 1;
+}
+
+static const WCHAR *get_index_name( const struct font_index_face *face, const WCHAR **ptr, int i )
+{
+    const WCHAR *name = *ptr;
+
+    *ptr += lstrlenW( name ) + 1;
+    return (face->null_names & (1 << i)) ? NULL : name;
+}
+
+/* check that a face record is large enough and that its names are terminated inside it */
+static BOOL check_index_face( const struct font_index_face *face )
+{
+    const WCHAR *ptr = face->names, *end = (const WCHAR *)((const BYTE *)face + face->hdr.len);
+    int i;
+
+    if (face->hdr.len < offsetof( struct font_index_face, names )) return FALSE;
+    for (i = 0; i < 5; i++)
+    {
+        while (ptr < end && *ptr) ptr++;
+        if (ptr++ >= end) return FALSE;
+    }
+    return TRUE;
+}
+
+static void add_font_index_face( const WCHAR *family_name, const WCHAR *second_name, const WCHAR *style,
+                                 const WCHAR *fullname, const WCHAR *file, UINT index, FONTSIGNATURE fs,
+                                 DWORD ntmflags, DWORD weight, DWORD version, DWORD flags,
+                                 const struct bitmap_font_size *size )
+{
+    struct font_index_face *face;
+    SIZE_T len = 5;
+    WCHAR *ptr;
+
+    if (family_name) len += lstrlenW( family_name );
+    if (second_name) len += lstrlenW( second_name );
+    if (style) len += lstrlenW( style );
+    if (fullname) len += lstrlenW( fullname );
+    if (file) len += lstrlenW( file );
+
+    if (!(face = add_font_index_record( FONT_INDEX_FACE, offsetof( struct font_index_face, names[len] ))))
+        return;
+    face->index    = index;
+    face->flags    = flags;
+    face->ntmflags = ntmflags;
+    face->weight   = weight;
+    face->version  = version;
+    face->fs       = fs;
+    if (size) face->size = *size;
+    else face->scalable = TRUE;
+
+    ptr = put_index_name( face, face->names, family_name, 0 );
+    ptr = put_index_name( face, ptr, second_name, 1 );
+    ptr = put_index_name( face, ptr, style, 2 );
+    ptr = put_index_name( face, ptr, fullname, 3 );
+    put_index_name( face, ptr, file, 4 );
+}
+
+static BOOL load_font_index(void)
+{
+    UNICODE_STRING nameW = { sizeof(font_indexW) - sizeof(WCHAR), sizeof(font_indexW), (WCHAR *)font_indexW };
+    KEY_VALUE_PARTIAL_INFORMATION_ALIGN64 *info, header;
+    const struct font_index_record *record;
+    const BYTE *ptr, *end;
+    DWORD faces = 0;
+    ULONG size;
+
+    /* use the aligned variant, records contain 64-bit fields */
+    if (NtQueryValueKey( wine_fonts_cache_key, &nameW, KeyValuePartialInformationAlign64,
+                         &header, sizeof(header), &size ) != STATUS_BUFFER_OVERFLOW)
+        return FALSE;
+    if (!(info = malloc( size ))) return FALSE;
+    if (NtQueryValueKey( wine_fonts_cache_key, &nameW, KeyValuePartialInformationAlign64, info, size, &size ))
+        goto failed;
+
+    ptr = info->Data;
+    end = ptr + info->DataLength;
+    if (info->Type != REG_BINARY || info->DataLength < 8 || *(const DWORD *)ptr != FONT_INDEX_VERSION)
+        goto failed;
+
+    /* check that none of the paths changed before adding anything */
+    for (ptr += 8; ptr + sizeof(*record) <= end; ptr += record->len)
+    {
+        const struct font_index_path *path;
+        ULONGLONG mtime, size, inode;
+
+        record = (const struct font_index_record *)ptr;
+        if (record->len < sizeof(*record) || record->len > end - ptr) goto failed;
+        if (record->type == FONT_INDEX_FACE && !check_index_face( (const struct font_index_face *)record ))
+        {
+            WARN( "invalid face record, rebuilding the font index\n" );
+            goto failed;
+        }
+        if (record->type != FONT_INDEX_PATH) continue;
+        path = (const struct font_index_path *)record;
+        if (record->len <= offsetof( struct font_index_path, path ) ||
+            !memchr( path->path, 0, record->len - offsetof( struct font_index_path, path ) ))
+        {
+            WARN( "invalid path record, rebuilding the font index\n" );
+            goto failed;
+        }
+        get_index_path_status( path->path, &mtime, &size, &inode );
+        if (path->mtime != mtime || path->size != size || path->inode != inode)
+        {
+            TRACE( "%s changed, rebuilding the font index\n", debugstr_a(path->path) );
+            goto failed;
+        }
+    }
+
+    for (ptr = info->Data + 8; ptr + sizeof(*record) <= end; ptr += record->len)
+    {
+        const struct font_index_face *face;
+        const WCHAR *names, *family, *second, *style, *full, *file;
+
+        record = (const struct font_index_record *)ptr;
+        if (record->type != FONT_INDEX_FACE) continue;
+        face = (const struct font_index_face *)record;
+        names = face->names;
+        family = get_index_name( face, &names, 0 );
+        second = get_index_name( face, &names, 1 );
+        style  = get_index_name( face, &names, 2 );
+        full   = get_index_name( face, &names, 3 );
+        file   = get_index_name( face, &names, 4 );
+        add_gdi_face( family, second, style, full, file, NULL, 0, face->index, face->fs,
+                      face->ntmflags, face->weight, face->version, face->flags,
+                      face->scalable ? NULL : &face->size );
+        faces++;
+    }
+    TRACE( "loaded %u faces from the font index\n", faces );
+    free( info );
+    return TRUE;
+
+failed:
+    free( info );
+    return FALSE;
+}
+
+static void load_system_fonts(void)
+{
+    if (wine_fonts_cache_key && load_font_index()) return;
+
+    font_index.size = font_index.max_size = 0;
+    font_index.path_count = 0;
+    if ((font_index.data = malloc( 0x10000 )))
+    {
+        font_index.max_size = 0x10000;
+        font_index.size = 8;
+        *(DWORD *)font_index.data = FONT_INDEX_VERSION;
+    }
+
+    font_funcs->load_fonts();
+
+    /* the index can only be checked against paths, don't store it if the backend didn't report any */
+    if (font_index.data && font_index.path_count && wine_fonts_cache_key)
+        set_reg_value( wine_fonts_cache_key, font_indexW, REG_BINARY, font_index.data, font_index.size );
+    free( font_index.data );
+    font_index.data = NULL;
+}
+
 int add_gdi_face( const WCHAR *family_name, const WCHAR *second_name,
                   const WCHAR *style, const WCHAR *fullname, const WCHAR *file,
                   void *data_ptr, SIZE_T data_size, UINT index, FONTSIGNATURE fs,
@@ -1216,6 +1499,10 @@ int add_gdi_face( const WCHAR *family_name, const WCHAR *second_name,
     struct gdi_font_family *family;
     int ret = 0;
 
+    if (font_index.data && !data_ptr)
+        add_font_index_face( family_name, second_name, style, fullname, file, index, fs,
+                             ntmflags, weight, version, flags, size );
+
     if ((family = find_family_from_name( family_name ))) family->refcount++;
     else if (!(family = create_family( family_name, second_name ))) return ret;
 
@@ -2531,6 +2818,243 @@ static void set_gdi_font_glyph_metrics( struct gdi_font *font, UINT index,
 }
 
 
+/* shared glyph bitmap cache */
+
+struct glyph_cache_key
+{
+    UINT64   file_hash;     /* hash of the face file name */
+    FILETIME writetime;     /* modification time of the face file */
+    UINT     face_index;
+    UINT     aa_flags;      /* antialiasing mode */
+    LONG     height;        /* size */
+    LONG     width;
+    LONG     escapement;
+    LONG     orientation;
+    LONG     weight;
+    UINT     flags;         /* italic and faked styles */
+    FMAT2    matrix;        /* transform */
+    UINT     index;         /* glyph index */
+    UINT     format;        /* GGO_* bitmap format */
+};
+
+struct glyph_cache_entry
+{
+    UINT                   next;  /* offset of the next entry in the same hash bucket */
+    UINT                   size;  /* size of the bitmap */
+    struct glyph_cache_key key;
+    GLYPHMETRICS           gm;
+    ABC                    abc;
+    BYTE                   bits[1];
+};
+
+#define GLYPH_CACHE_HASH_SIZE 4096
+#define GLYPH_CACHE_MAX_CHAIN 64  /* lookups give up after that many entries */
+
+/* header of the section shared by all the processes of the session
+ *
+ * Entries are appended to the section, and the whole cache is emptied once it is full.
+ * Readers don't lock anything, they check that the sequence number didn't change while
+ * they were copying an entry. A process dying while holding the lock only disables the
+ * cache, it never blocks the other processes. */
+struct glyph_cache
+{
+    LONG   lock;      /* held by the process modifying the cache */
+    LONG   seq;       /* odd while the cache is being modified */
+    UINT   pos;       /* offset of the free space, 0 if the cache was never used */
+    UINT   padding;
+    LONG64 hits;      /* statistics, for all the processes using the cache */
+    LONG64 misses;
+    LONG64 resets;    /* number of times the cache was full and got emptied */
+    UINT   buckets[GLYPH_CACHE_HASH_SIZE];  /* offset of the first entry of each hash bucket */
+};
+
+static struct glyph_cache *glyph_cache;  /* only used if enabled with the GlyphCacheSize setting */
+static UINT glyph_cache_size;
+
+static void init_glyph_cache( UINT size )
+{
+    static WCHAR wine_glyph_cacheW[] =
+        {'\\','B','a','s','e','N','a','m','e','d','O','b','j','e','c','t','s',
+         '\\','_','_','W','I','N','E','_','G','L','Y','P','H','_','C','A','C','H','E','_','_'};
+    OBJECT_ATTRIBUTES attr = { sizeof(attr) };
+    SECTION_BASIC_INFORMATION info;
+    LARGE_INTEGER section_size;
+    UNICODE_STRING name;
+    SIZE_T view_size = 0;
+    void *ptr = NULL;
+    NTSTATUS status;
+    HANDLE handle;
+
+    attr.Attributes = OBJ_OPENIF;
+    attr.ObjectName = &name;
+    name.Buffer = wine_glyph_cacheW;
+    name.Length = name.MaximumLength = sizeof(wine_glyph_cacheW);
+    section_size.QuadPart = size;
+
+    /* the first process sets the size, the others use the existing section */
+    if (NtCreateSection( &handle, SECTION_QUERY | SECTION_MAP_READ | SECTION_MAP_WRITE, &attr,
+                         &section_size, PAGE_READWRITE, SEC_COMMIT, 0 ) < 0)
+        return;
+    if (!NtQuerySection( handle, SectionBasicInformation, &info, sizeof(info), NULL ))
+        size = min( info.Size.QuadPart, size );
+    status = NtMapViewOfSection( handle, GetCurrentProcess(), &ptr, 0, 0, NULL, &view_size,
+                                 ViewShare, 0, PAGE_READWRITE );
+    NtClose( handle );
+    if (status)
+    {
+        WARN( "failed to map the glyph cache, status %#x\n", (int)status );
+        return;
+    }
+    if (size < 4 * sizeof(*glyph_cache))
+    {
+        NtUnmapViewOfSection( GetCurrentProcess(), ptr );
+        return;
+    }
+    glyph_cache = ptr;
+    glyph_cache_size = min( size, view_size );
+    TRACE( "using %u bytes glyph cache at %p\n", glyph_cache_size, glyph_cache );
+}
+
+static BOOL is_glyph_bitmap_format( UINT format )
+{
+    switch (format)
+    {
+    case GGO_BITMAP:
+    case GGO_GRAY2_BITMAP:
+    case GGO_GRAY4_BITMAP:
+    case GGO_GRAY8_BITMAP:
+    case WINE_GGO_GRAY16_BITMAP:
+    case WINE_GGO_HRGB_BITMAP:
+    case WINE_GGO_HBGR_BITMAP:
+    case WINE_GGO_VRGB_BITMAP:
+    case WINE_GGO_VBGR_BITMAP:
+        return TRUE;
+    }
+    return FALSE;
+}
+
+static BOOL get_glyph_cache_key( const struct gdi_font *font, UINT index, UINT format,
+                                 struct glyph_cache_key *key )
+{
+    UINT64 hash = 0xcbf29ce484222325ull;
+    const WCHAR *p;
+
+    /* fonts loaded from memory can't be identified in other processes */
+    if (!font->file[0]) return FALSE;
+
+    for (p = font->file; *p; p++) hash = (hash ^ *p) * 0x100000001b3ull;
+    memset( key, 0, sizeof(*key) );
+    key->file_hash   = hash;
+    key->writetime   = font->writetime;
+    key->face_index  = font->face_index;
+    key->aa_flags    = font->aa_flags;
+    key->height      = font->lf.lfHeight;
+    key->width       = font->lf.lfWidth;
+    key->escapement  = font->lf.lfEscapement;
+    key->orientation = font->lf.lfOrientation;
+    key->weight      = font->lf.lfWeight;
+    key->flags       = (font->lf.lfItalic != 0) | (font->fake_italic << 1) | (font->fake_bold << 2) |
+                       (font->can_use_bitmap << 3);
+    key->matrix      = font->matrix;
+    key->index       = index;
+    key->format      = format;
+    return TRUE;
+}
+
+static UINT hash_glyph_cache_key( const struct glyph_cache_key *key )
+{
+    const BYTE *ptr = (const BYTE *)key;
+    UINT i, hash = 0x811c9dc5;
+
+    for (i = 0; i < sizeof(*key); i++) hash = (hash ^ ptr[i]) * 0x01000193;
+    return hash % GLYPH_CACHE_HASH_SIZE;
+}
+
+static BOOL get_cached_glyph_bitmap( const struct glyph_cache_key *key, GLYPHMETRICS *gm, ABC *abc,
+                                     DWORD buflen, void *buf, DWORD *ret )
+{
+    const UINT max_pos = glyph_cache_size - offsetof( struct glyph_cache_entry, bits );
+    const struct glyph_cache_entry *entry;
+    UINT pos, size, count;
+    LONG seq;
+
+    seq = ReadAcquire( &glyph_cache->seq );
+    if (seq & 1) goto miss;
+
+    pos = ((volatile UINT *)glyph_cache->buckets)[hash_glyph_cache_key( key )];
+    for (count = 0; pos && count < GLYPH_CACHE_MAX_CHAIN; count++, pos = entry->next)
+    {
+        /* the cache may be modified under us, don't trust anything until the sequence number is checked */
+        if (pos % 8 || pos < sizeof(*glyph_cache) || pos > max_pos) break;
+        entry = (const struct glyph_cache_entry *)((const char *)glyph_cache + pos);
+        if (memcmp( &entry->key, key, sizeof(*key) )) continue;
+
+        if ((size = entry->size) > max_pos - pos) break;
+        *gm  = entry->gm;
+        *abc = entry->abc;
+        *ret = size;
+        if (buf && buflen)
+        {
+            if (size > buflen) *ret = GDI_ERROR;
+            else memcpy( buf, entry->bits, size );
+        }
+        MemoryBarrier();
+        if (ReadNoFence( &glyph_cache->seq ) != seq) break;
+        InterlockedIncrement64( &glyph_cache->hits );
+        return TRUE;
+    }
+
+miss:
+    InterlockedIncrement64( &glyph_cache->misses );
+    return FALSE;
+}
+
+static BOOL lock_glyph_cache(void)
+{
+    UINT i;
+
+    for (i = 0; i < 100; i++)
+    {
+        if (!InterlockedCompareExchange( &glyph_cache->lock, 1, 0 )) return TRUE;
+        YieldProcessor();
+    }
+    return FALSE;  /* another process is busy with it, don't wait */
+}
+
+static void set_cached_glyph_bitmap( const struct glyph_cache_key *key, const GLYPHMETRICS *gm,
+                                     const ABC *abc, DWORD size, const void *bits )
+{
+    UINT start = (sizeof(*glyph_cache) + 7) & ~7, bucket = hash_glyph_cache_key( key ), pos, len;
+    struct glyph_cache_entry *entry;
+
+    len = (offsetof( struct glyph_cache_entry, bits[size] ) + 7) & ~7;
+    if (len > (glyph_cache_size - start) / 16) return;  /* don't let a single glyph empty the cache */
+    if (!lock_glyph_cache()) return;
+
+    InterlockedIncrement( &glyph_cache->seq );
+    if (!(pos = glyph_cache->pos) || len > glyph_cache_size - pos)
+    {
+        if (pos)
+        {
+            memset( glyph_cache->buckets, 0, sizeof(glyph_cache->buckets) );
+            glyph_cache->resets++;
+        }
+        pos = start;
+    }
+    entry = (struct glyph_cache_entry *)((char *)glyph_cache + pos);
+    entry->next = glyph_cache->buckets[bucket];
+    entry->size = size;
+    entry->key  = *key;
+    entry->gm   = *gm;
+    entry->abc  = *abc;
+    memcpy( entry->bits, bits, size );
+    glyph_cache->buckets[bucket] = pos;
+    glyph_cache->pos = pos + len;
+    InterlockedIncrement( &glyph_cache->seq );
+    InterlockedExchange( &glyph_cache->lock, 0 );
+}
+
+
 /* GSUB table support */
 
 typedef struct
@@ -3764,6 +4288,9 @@ static DWORD get_glyph_outline( struct gdi_font *font, UINT glyph, UINT format,
     DWORD ret = 1;
     UINT index = glyph;
     BOOL tategaki = (*get_gdi_font_name( font ) == '@');
+    /* vertical fonts rotate glyphs depending on the character, not only on the glyph index */
+    BOOL cache_bitmap = glyph_cache && !tategaki && is_glyph_bitmap_format( format & ~GGO_GLYPH_INDEX );
+    struct glyph_cache_key key;
 
     if (format & GGO_GLYPH_INDEX)
     {
@@ -3791,11 +4318,20 @@ static DWORD get_glyph_outline( struct gdi_font *font, UINT glyph, UINT format,
     if (format == GGO_METRICS && !mat && get_gdi_font_glyph_metrics( font, index, &gm, &abc ))
         goto done;
 
+    cache_bitmap = cache_bitmap && !mat && get_glyph_cache_key( font, index, format, &key );
+    if (cache_bitmap && get_cached_glyph_bitmap( &key, &gm, &abc, buflen, buf, &ret ))
+    {
+        if (ret == GDI_ERROR) return ret;
+        goto done;
+    }
+
     ret = font_funcs->get_glyph_outline( font, index, format, &gm, &abc, buflen, buf, mat, tategaki );
     if (ret == GDI_ERROR) return ret;
 
     if (format == GGO_METRICS && !mat)
         set_gdi_font_glyph_metrics( font, index, &gm, &abc );
+    else if (cache_bitmap && buf && buflen && ret <= buflen)  /* size queries don't render anything */
+        set_cached_glyph_bitmap( &key, &gm, &abc, ret, buf );
 
 done:
     if (gm_ret) *gm_ret = gm;
@@ -4729,6 +5265,9 @@ static UINT init_font_options(void)
         antialias_fakes = (wcschr( valsW, *(const WCHAR *)info->Data ) != NULL);
     }
 
+    if (get_key_value( wine_fonts_key, "GlyphCacheSize", &val ) && val)
+        init_glyph_cache( min( val, 256 ) * 1024 * 1024 );  /* in megabytes */
+
     if ((key = reg_open_hkcu_key( "Control Panel\\Desktop" )))
     {
         /* FIXME: handle vertical orientations even though Windows doesn't */
@@ -6752,18 +7291,22 @@ UINT font_init(void)
 
     load_system_bitmap_fonts();
     load_file_system_fonts();
-    font_funcs->load_fonts();
 
     attr.Attributes = OBJ_OPENIF;
     attr.ObjectName = &name;
     name.Buffer = wine_font_mutexW;
     name.Length = name.MaximumLength = sizeof(wine_font_mutexW);
 
-    if (NtCreateMutant( &mutex, MUTEX_ALL_ACCESS, &attr, FALSE ) < 0) return dpi;
+    if (NtCreateMutant( &mutex, MUTEX_ALL_ACCESS, &attr, FALSE ) < 0)
+    {
+        font_funcs->load_fonts();
+        return dpi;
+    }
     NtWaitForSingleObject( mutex, FALSE, NULL );
 
     wine_fonts_cache_key = reg_create_key( wine_fonts_key, cacheW, sizeof(cacheW),
                                            REG_OPTION_VOLATILE, &disposition );
+    load_system_fonts();
 
     if (disposition == REG_CREATED_NEW_KEY)
     {
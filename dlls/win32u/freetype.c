@@ -138,6 +138,7 @@ MAKE_FUNCPTR(FcPatternDestroy);
 MAKE_FUNCPTR(FcPatternGetBool);
 MAKE_FUNCPTR(FcPatternGetInteger);
 MAKE_FUNCPTR(FcPatternGetString);
+MAKE_FUNCPTR(FcConfigGetConfigFiles);
 MAKE_FUNCPTR(FcConfigGetFontDirs);
 MAKE_FUNCPTR(FcConfigGetCurrent);
 MAKE_FUNCPTR(FcCacheCopySet);
@@ -1256,6 +1257,7 @@ static void init_fontconfig(void)
     LOAD_FUNCPTR(FcPatternGetBool);
     LOAD_FUNCPTR(FcPatternGetInteger);
     LOAD_FUNCPTR(FcPatternGetString);
+    LOAD_FUNCPTR(FcConfigGetConfigFiles);
     LOAD_FUNCPTR(FcConfigGetFontDirs);
     LOAD_FUNCPTR(FcConfigGetCurrent);
     LOAD_FUNCPTR(FcCacheCopySet);
@@ -1294,7 +1296,7 @@ static void init_fontconfig(void)
 
 static void fontconfig_add_fonts_from_dir_list( FcConfig *config, FcStrList *dir_list, FcStrSet *done_set, UINT flags )
 {
-    const FcChar8 *dir;
+    const FcChar8 *dir, *file, *prev_file;
     FcFontSet *font_set = NULL;
     FcStrList *subdir_list = NULL;
     FcStrSet *subdir_set = NULL;
@@ -1308,11 +1310,21 @@ static void fontconfig_add_fonts_from_dir_list( FcConfig *config, FcStrList *dir
         if (pFcStrSetMember( done_set, dir )) continue;
 
         TRACE( "adding fonts from %s\n", dir );
+        add_font_index_path( (const char *)dir );
         if (!(cache = pFcDirCacheRead( dir, FcFalse, config ))) continue;
 
         if (!(font_set = pFcCacheCopySet( cache ))) goto done;
-        for (i = 0; i < font_set->nfont; i++)
+        for (i = 0, prev_file = NULL; i < font_set->nfont; i++)
+        {
+            /* files replaced in place don't change the directory */
+            if (pFcPatternGetString( font_set->fonts[i], FC_FILE, 0, (FcChar8 **)&file ) == FcResultMatch &&
+                (!prev_file || strcmp( (const char *)file, (const char *)prev_file )))
+            {
+                add_font_index_path( (const char *)file );
+                prev_file = file;
+            }
             fontconfig_add_font( font_set->fonts[i], flags );
+        }
         pFcFontSetDestroy( font_set );
         font_set = NULL;
 
@@ -1337,6 +1349,38 @@ done:
     if (cache) pFcDirCacheUnload( cache );
 }
 
+/* the font directories and antialiasing flags depend on the configuration files,
+ * and new files in their directories, such as conf.d, are picked up as well */
+static void fontconfig_add_config_to_index( FcConfig *config )
+{
+    const FcChar8 *file;
+    FcStrList *file_list;
+    FcStrSet *dir_set;
+    char *dir, *p;
+
+    if (!(dir_set = pFcStrSetCreate())) return;
+    if ((file_list = pFcConfigGetConfigFiles( config )))
+    {
+        while ((file = pFcStrListNext( file_list )))
+        {
+            add_font_index_path( (const char *)file );
+            if (!(dir = strdup( (const char *)file ))) continue;
+            if ((p = strrchr( dir, '/' )) && p != dir)
+            {
+                *p = 0;
+                if (!pFcStrSetMember( dir_set, (const FcChar8 *)dir ))
+                {
+                    pFcStrSetAdd( dir_set, (const FcChar8 *)dir );
+                    add_font_index_path( dir );
+                }
+            }
+            free( dir );
+        }
+        pFcStrListDone( file_list );
+    }
+    pFcStrSetDestroy( dir_set );
+}
+
 static void load_fontconfig_fonts( void )
 {
     FcStrList *dir_list = NULL;
@@ -1345,6 +1389,7 @@ static void load_fontconfig_fonts( void )
 
     if (!fontconfig_enabled) return;
     if (!(config = pFcConfigGetCurrent())) goto done;
+    fontconfig_add_config_to_index( config );
     if (!(done_set = pFcStrSetCreate())) goto done;
     if (!(dir_list = pFcConfigGetFontDirs( config ))) goto done;
 
@@ -345,6 +345,7 @@ extern int add_gdi_face( const WCHAR *family_name, const WCHAR *second_name,
                          void *data_ptr, SIZE_T data_size, UINT index, FONTSIGNATURE fs,
                          DWORD ntmflags, DWORD weight, DWORD version, DWORD flags,
                          const struct bitmap_font_size *size );
+extern void add_font_index_path( const char *unix_path );
 extern UINT font_init(void);
 extern const struct font_backend_funcs *init_freetype_lib(void);
 
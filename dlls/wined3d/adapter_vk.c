@@ -444,10 +444,13 @@ static HRESULT adapter_vk_create_device(struct wined3d *wined3d, const struct wi
         goto fail;
     }
 
+    wined3d_device_vk_create_pipeline_cache(device_vk, physical_device);
+
     if (FAILED(hr = wined3d_device_init(&device_vk->d, wined3d, adapter->ordinal, device_type, focus_window,
             flags, surface_alignment, levels, level_count, vk_info->supported, device_parent)))
     {
         WARN("Failed to initialize device, hr %#lx.\n", hr);
+        wined3d_device_vk_destroy_pipeline_cache(device_vk, physical_device);
         wined3d_allocator_cleanup(&device_vk->allocator);
         goto fail;
     }
@@ -478,6 +481,7 @@ static void adapter_vk_destroy_device(struct wined3d_device *device)
 
     wined3d_device_cleanup(&device_vk->d);
     wined3d_allocator_cleanup(&device_vk->allocator);
+    wined3d_device_vk_destroy_pipeline_cache(device_vk, wined3d_adapter_vk(device->adapter)->physical_device);
 
     wined3d_lock_cleanup(&device_vk->allocator_cs);
 
@@ -1741,7 +1745,8 @@ static void adapter_vk_draw_primitive(struct wined3d_device *device,
     if (!(vk_command_buffer = wined3d_context_vk_apply_draw_state(context_vk,
             state, indirect_vk, parameters->indexed)))
     {
-        ERR("Failed to apply draw state.\n");
+        if (!context_vk->graphics.shaders_pending)
+            ERR("Failed to apply draw state.\n");
         context_release(&context_vk->c);
         return;
     }
@@ -2410,6 +2415,7 @@ static bool wined3d_adapter_vk_init_device_extensions(struct wined3d_adapter_vk
         {VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME,    VK_API_VERSION_1_3},
         {VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME,    ~0u},
         {VK_EXT_HOST_QUERY_RESET_EXTENSION_NAME,            VK_API_VERSION_1_2},
+        {VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME,  VK_API_VERSION_1_3},
         {VK_EXT_SAMPLER_FILTER_MINMAX_EXTENSION_NAME,       VK_API_VERSION_1_2},
         {VK_EXT_SHADER_STENCIL_EXPORT_EXTENSION_NAME,       ~0u},
         {VK_EXT_TRANSFORM_FEEDBACK_EXTENSION_NAME,          ~0u},
@@ -2444,6 +2450,7 @@ static bool wined3d_adapter_vk_init_device_extensions(struct wined3d_adapter_vk
         {VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME,     WINED3D_VK_EXT_EXTENDED_DYNAMIC_STATE2},
         {VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME,     WINED3D_VK_EXT_EXTENDED_DYNAMIC_STATE3},
         {VK_EXT_HOST_QUERY_RESET_EXTENSION_NAME,             WINED3D_VK_EXT_HOST_QUERY_RESET},
+        {VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME,   WINED3D_VK_EXT_PIPELINE_CREATION_FEEDBACK},
         {VK_EXT_SAMPLER_FILTER_MINMAX_EXTENSION_NAME,        WINED3D_VK_EXT_SAMPLER_FILTER_MINMAX},
         {VK_EXT_SHADER_STENCIL_EXPORT_EXTENSION_NAME,        WINED3D_VK_EXT_SHADER_STENCIL_EXPORT},
         {VK_EXT_TRANSFORM_FEEDBACK_EXTENSION_NAME,           WINED3D_VK_EXT_TRANSFORM_FEEDBACK},
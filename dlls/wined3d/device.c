@@ -1129,6 +1129,264 @@ void wined3d_device_vk_destroy_null_views(struct wined3d_device_vk *device_vk, s
     wined3d_context_vk_destroy_vk_buffer_view(context_vk, v->vk_view_buffer_uint, id);
 }
 
+#define WINED3D_PIPELINE_CACHE_MAGIC    WINEMAKEFOURCC('W', '3', 'P', 'C')
+#define WINED3D_PIPELINE_CACHE_VERSION  1
+/* Only the VkPipelineCache data is persisted, and there is no eviction of
+ * individual pipelines: a cache that grows past this size is not saved, and
+ * the existing file is deleted so that the next run starts from scratch. */
+#define WINED3D_PIPELINE_CACHE_MAX_SIZE (256u * 1024 * 1024)
+
+struct wined3d_pipeline_cache_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vendor_id;
+    uint32_t device_id;
+    uint32_t driver_version;
+    uint32_t size;
+    uint8_t uuid[VK_UUID_SIZE];
+};
+
+static bool wined3d_device_vk_get_pipeline_cache_file(const struct wined3d_device_vk *device_vk,
+        const VkPhysicalDeviceProperties *properties, char *path, unsigned int size)
+{
+    char app_name[MAX_PATH];
+    int len;
+
+    if (!wined3d_settings.pipeline_cache_path)
+        return false;
+    if (!wined3d_get_app_name(app_name, ARRAY_SIZE(app_name)))
+        strcpy(app_name, "wined3d");
+
+    len = snprintf(path, size, "%s\\%s.%04x-%04x.vkcache", wined3d_settings.pipeline_cache_path,
+            app_name, properties->vendorID, properties->deviceID);
+    return len > 0 && len < (int)size;
+}
+
+static void wined3d_pipeline_cache_init_header(struct wined3d_pipeline_cache_header *header,
+        const VkPhysicalDeviceProperties *properties, uint32_t size)
+{
+    header->magic = WINED3D_PIPELINE_CACHE_MAGIC;
+    header->version = WINED3D_PIPELINE_CACHE_VERSION;
+    header->vendor_id = properties->vendorID;
+    header->device_id = properties->deviceID;
+    header->driver_version = properties->driverVersion;
+    header->size = size;
+    memcpy(header->uuid, properties->pipelineCacheUUID, VK_UUID_SIZE);
+}
+
+static void *wined3d_pipeline_cache_load(const char *path, const VkPhysicalDeviceProperties *properties,
+        size_t *size)
+{
+    struct wined3d_pipeline_cache_header header, expected;
+    void *data = NULL;
+    DWORD read;
+    HANDLE file;
+
+    if ((file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL)) == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    if (!ReadFile(file, &header, sizeof(header), &read, NULL) || read != sizeof(header))
+        goto done;
+    wined3d_pipeline_cache_init_header(&expected, properties, header.size);
+    if (memcmp(&header, &expected, sizeof(header)) || header.size > WINED3D_PIPELINE_CACHE_MAX_SIZE)
+    {
+        TRACE("Ignoring stale pipeline cache %s.\n", debugstr_a(path));
+        goto done;
+    }
+
+    if (!(data = malloc(header.size)))
+        goto done;
+    if (!ReadFile(file, data, header.size, &read, NULL) || read != header.size)
+    {
+        WARN("Failed to read pipeline cache %s.\n", debugstr_a(path));
+        free(data);
+        data = NULL;
+        goto done;
+    }
+    *size = header.size;
+
+done:
+    CloseHandle(file);
+    return data;
+}
+
+void wined3d_device_vk_create_pipeline_cache(struct wined3d_device_vk *device_vk, VkPhysicalDevice physical_device)
+{
+    const struct wined3d_vk_info *vk_info = &device_vk->vk_info;
+    VkPipelineCacheCreateInfo cache_info;
+    VkPhysicalDeviceProperties properties;
+    char path[MAX_PATH];
+    void *data = NULL;
+    size_t size = 0;
+    VkResult vr;
+
+    VK_CALL(vkGetPhysicalDeviceProperties(physical_device, &properties));
+    if (wined3d_device_vk_get_pipeline_cache_file(device_vk, &properties, path, sizeof(path)))
+        data = wined3d_pipeline_cache_load(path, &properties, &size);
+
+    cache_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cache_info.pNext = NULL;
+    cache_info.flags = 0;
+    cache_info.initialDataSize = size;
+    cache_info.pInitialData = data;
+    if ((vr = VK_CALL(vkCreatePipelineCache(device_vk->vk_device, &cache_info,
+            NULL, &device_vk->vk_pipeline_cache))) < 0 && data)
+    {
+        WARN("Failed to create pipeline cache from saved data, vr %s.\n", wined3d_debug_vkresult(vr));
+        cache_info.initialDataSize = 0;
+        cache_info.pInitialData = NULL;
+        vr = VK_CALL(vkCreatePipelineCache(device_vk->vk_device, &cache_info, NULL, &device_vk->vk_pipeline_cache));
+    }
+    if (vr < 0)
+    {
+        WARN("Failed to create pipeline cache, vr %s.\n", wined3d_debug_vkresult(vr));
+        device_vk->vk_pipeline_cache = VK_NULL_HANDLE;
+    }
+    else if (data)
+    {
+        TRACE("Loaded %Iu bytes of pipeline cache data from %s.\n", size, debugstr_a(path));
+    }
+    free(data);
+}
+
+static void wined3d_pipeline_cache_save(const char *path, const struct wined3d_pipeline_cache_header *header,
+        const void *data)
+{
+    char tmp_path[MAX_PATH + 4];
+    DWORD written;
+    HANDLE file;
+    BOOL ret;
+
+    /* Write to a temporary file first, so that other processes never see a partial cache. */
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    if ((file = CreateFileA(tmp_path, GENERIC_WRITE, 0, NULL,
+            CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL)) == INVALID_HANDLE_VALUE)
+    {
+        WARN("Failed to create %s, error %lu.\n", debugstr_a(tmp_path), GetLastError());
+        return;
+    }
+    ret = WriteFile(file, header, sizeof(*header), &written, NULL) && written == sizeof(*header)
+            && WriteFile(file, data, header->size, &written, NULL) && written == header->size;
+    CloseHandle(file);
+
+    if (!ret || !MoveFileExA(tmp_path, path, MOVEFILE_REPLACE_EXISTING))
+    {
+        WARN("Failed to write pipeline cache %s, error %lu.\n", debugstr_a(path), GetLastError());
+        DeleteFileA(tmp_path);
+    }
+}
+
+void wined3d_device_vk_destroy_pipeline_cache(struct wined3d_device_vk *device_vk, VkPhysicalDevice physical_device)
+{
+    const struct wined3d_vk_info *vk_info = &device_vk->vk_info;
+    struct wined3d_pipeline_cache_header header;
+    VkPhysicalDeviceProperties properties;
+    char path[MAX_PATH];
+    void *data = NULL;
+    size_t size;
+    VkResult vr;
+
+    if (!device_vk->vk_pipeline_cache)
+        return;
+
+    TRACE("Pipeline cache hits %u, misses %u.\n", device_vk->pipeline_cache_hits, device_vk->pipeline_cache_misses);
+
+    VK_CALL(vkGetPhysicalDeviceProperties(physical_device, &properties));
+    if (!wined3d_device_vk_get_pipeline_cache_file(device_vk, &properties, path, sizeof(path)))
+        goto done;
+
+    if ((vr = VK_CALL(vkGetPipelineCacheData(device_vk->vk_device, device_vk->vk_pipeline_cache, &size, NULL))) < 0)
+    {
+        WARN("Failed to get pipeline cache size, vr %s.\n", wined3d_debug_vkresult(vr));
+        goto done;
+    }
+    if (size > WINED3D_PIPELINE_CACHE_MAX_SIZE)
+    {
+        TRACE("Discarding pipeline cache of %Iu bytes.\n", size);
+        DeleteFileA(path);
+        goto done;
+    }
+    if (!size || !(data = malloc(size)))
+        goto done;
+    if ((vr = VK_CALL(vkGetPipelineCacheData(device_vk->vk_device, device_vk->vk_pipeline_cache, &size, data))))
+    {
+        WARN("Failed to get pipeline cache data, vr %s.\n", wined3d_debug_vkresult(vr));
+        goto done;
+    }
+
+    wined3d_pipeline_cache_init_header(&header, &properties, size);
+    wined3d_pipeline_cache_save(path, &header, data);
+    TRACE("Saved %Iu bytes of pipeline cache data to %s.\n", size, debugstr_a(path));
+
+done:
+    free(data);
+    VK_CALL(vkDestroyPipelineCache(device_vk->vk_device, device_vk->vk_pipeline_cache, NULL));
+    device_vk->vk_pipeline_cache = VK_NULL_HANDLE;
+}
+
+static void wined3d_device_vk_update_pipeline_cache_stats(struct wined3d_device_vk *device_vk,
+        const VkPipelineCreationFeedback *feedback)
+{
+    if (!(feedback->flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT))
+        return;
+    if (feedback->flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT)
+        ++device_vk->pipeline_cache_hits;
+    else
+        ++device_vk->pipeline_cache_misses;
+}
+
+VkResult wined3d_device_vk_create_graphics_pipeline(struct wined3d_device_vk *device_vk,
+        const VkGraphicsPipelineCreateInfo *create_info, VkPipeline *pipeline)
+{
+    const struct wined3d_vk_info *vk_info = &device_vk->vk_info;
+    VkPipelineCreationFeedbackCreateInfo feedback_info;
+    VkGraphicsPipelineCreateInfo info = *create_info;
+    VkPipelineCreationFeedback feedback = {0};
+    VkResult vr;
+
+    if (vk_info->supported[WINED3D_VK_EXT_PIPELINE_CREATION_FEEDBACK])
+    {
+        feedback_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO;
+        feedback_info.pNext = info.pNext;
+        feedback_info.pPipelineCreationFeedback = &feedback;
+        feedback_info.pipelineStageCreationFeedbackCount = 0;
+        feedback_info.pPipelineStageCreationFeedbacks = NULL;
+        info.pNext = &feedback_info;
+    }
+
+    if ((vr = VK_CALL(vkCreateGraphicsPipelines(device_vk->vk_device,
+            device_vk->vk_pipeline_cache, 1, &info, NULL, pipeline))) >= 0)
+        wined3d_device_vk_update_pipeline_cache_stats(device_vk, &feedback);
+    return vr;
+}
+
+VkResult wined3d_device_vk_create_compute_pipeline(struct wined3d_device_vk *device_vk,
+        const VkComputePipelineCreateInfo *create_info, VkPipeline *pipeline)
+{
+    const struct wined3d_vk_info *vk_info = &device_vk->vk_info;
+    VkPipelineCreationFeedbackCreateInfo feedback_info;
+    VkComputePipelineCreateInfo info = *create_info;
+    VkPipelineCreationFeedback feedback = {0};
+    VkResult vr;
+
+    if (vk_info->supported[WINED3D_VK_EXT_PIPELINE_CREATION_FEEDBACK])
+    {
+        feedback_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO;
+        feedback_info.pNext = info.pNext;
+        feedback_info.pPipelineCreationFeedback = &feedback;
+        feedback_info.pipelineStageCreationFeedbackCount = 0;
+        feedback_info.pPipelineStageCreationFeedbacks = NULL;
+        info.pNext = &feedback_info;
+    }
+
+    if ((vr = VK_CALL(vkCreateComputePipelines(device_vk->vk_device,
+            device_vk->vk_pipeline_cache, 1, &info, NULL, pipeline))) >= 0)
+        wined3d_device_vk_update_pipeline_cache_stats(device_vk, &feedback);
+    return vr;
+}
+
 HRESULT CDECL wined3d_device_acquire_focus_window(struct wined3d_device *device, HWND window)
 {
     unsigned int screensaver_active;
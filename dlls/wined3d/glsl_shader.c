@@ -140,6 +140,24 @@ struct shader_glsl_priv
     struct wine_rb_tree ffp_vertex_shaders;
     struct wine_rb_tree ffp_fragment_shaders;
     BOOL legacy_lighting;
+
+    char *program_binary_path;
+    bool program_binaries_loaded;
+    bool program_binaries_dirty;
+    uint64_t program_binary_driver_hash;
+    struct wine_rb_tree program_binaries;
+    size_t program_binary_size;
+    unsigned int program_binary_hits;
+    unsigned int program_binary_misses;
+};
+
+struct glsl_program_binary
+{
+    struct wine_rb_entry entry;
+    uint64_t hash;
+    GLenum format;
+    GLsizei size;
+    BYTE data[1];
 };
 
 struct glsl_vs_program
@@ -631,6 +649,298 @@ void shader_glsl_validate_link(const struct wined3d_gl_info *gl_info, GLuint pro
     print_glsl_info_log(gl_info, program, TRUE);
 }
 
+#define WINED3D_PROGRAM_BINARY_MAGIC    WINEMAKEFOURCC('W', '3', 'P', 'B')
+#define WINED3D_PROGRAM_BINARY_VERSION  1
+/* As for the Vulkan pipeline cache, binaries are only added while the cache
+ * is below this size, and there is no eviction. */
+#define WINED3D_PROGRAM_BINARY_MAX_SIZE (256u * 1024 * 1024)
+#define WINED3D_PROGRAM_HASH_SEED       0xcbf29ce484222325ull
+
+struct glsl_program_binary_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t driver_hash;
+    uint32_t count;
+    uint32_t padding;
+};
+
+struct glsl_program_binary_record
+{
+    uint64_t hash;
+    uint32_t format;
+    uint32_t size;
+};
+
+static uint64_t glsl_hash_data(uint64_t hash, const void *data, size_t size)
+{
+    const BYTE *ptr = data;
+    size_t i;
+
+    /* FNV-1a */
+    for (i = 0; i < size; ++i)
+    {
+        hash ^= ptr[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static uint64_t glsl_hash_string(uint64_t hash, const char *str)
+{
+    return str ? glsl_hash_data(hash, str, strlen(str) + 1) : hash;
+}
+
+static int glsl_program_binary_compare(const void *key, const struct wine_rb_entry *entry)
+{
+    return wined3d_uint64_compare(*(const uint64_t *)key,
+            WINE_RB_ENTRY_VALUE(entry, struct glsl_program_binary, entry)->hash);
+}
+
+static void glsl_free_program_binary(struct wine_rb_entry *entry, void *param)
+{
+    free(WINE_RB_ENTRY_VALUE(entry, struct glsl_program_binary, entry));
+}
+
+static bool shader_glsl_add_program_binary(struct shader_glsl_priv *priv, struct glsl_program_binary *binary)
+{
+    if (priv->program_binary_size + binary->size > WINED3D_PROGRAM_BINARY_MAX_SIZE
+            || wine_rb_put(&priv->program_binaries, &binary->hash, &binary->entry) == -1)
+        return false;
+    priv->program_binary_size += binary->size;
+    return true;
+}
+
+static void shader_glsl_load_program_binaries(struct shader_glsl_priv *priv)
+{
+    struct glsl_program_binary_header header;
+    struct glsl_program_binary_record record;
+    struct glsl_program_binary *binary;
+    unsigned int i;
+    DWORD read;
+    HANDLE file;
+
+    if ((file = CreateFileA(priv->program_binary_path, GENERIC_READ, FILE_SHARE_READ, NULL,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL)) == INVALID_HANDLE_VALUE)
+        return;
+
+    if (!ReadFile(file, &header, sizeof(header), &read, NULL) || read != sizeof(header))
+        goto done;
+    if (header.magic != WINED3D_PROGRAM_BINARY_MAGIC || header.version != WINED3D_PROGRAM_BINARY_VERSION
+            || header.driver_hash != priv->program_binary_driver_hash)
+    {
+        TRACE("Ignoring stale program binary cache %s.\n", debugstr_a(priv->program_binary_path));
+        goto done;
+    }
+
+    for (i = 0; i < header.count; ++i)
+    {
+        if (!ReadFile(file, &record, sizeof(record), &read, NULL) || read != sizeof(record)
+                || record.size > WINED3D_PROGRAM_BINARY_MAX_SIZE)
+            break;
+        if (!(binary = malloc(offsetof(struct glsl_program_binary, data[record.size]))))
+            break;
+        binary->hash = record.hash;
+        binary->format = record.format;
+        binary->size = record.size;
+        if (!ReadFile(file, binary->data, record.size, &read, NULL) || read != record.size
+                || !shader_glsl_add_program_binary(priv, binary))
+        {
+            free(binary);
+            break;
+        }
+    }
+    if (i != header.count)
+        WARN("Failed to read program binary cache %s.\n", debugstr_a(priv->program_binary_path));
+    TRACE("Loaded %u program binaries from %s.\n", i, debugstr_a(priv->program_binary_path));
+
+done:
+    CloseHandle(file);
+}
+
+static void shader_glsl_save_program_binaries(struct shader_glsl_priv *priv)
+{
+    struct glsl_program_binary_header header;
+    struct glsl_program_binary_record record;
+    struct glsl_program_binary *binary;
+    char tmp_path[MAX_PATH + 4];
+    DWORD written;
+    HANDLE file;
+    BOOL ret;
+
+    TRACE("Program binary cache hits %u, misses %u.\n", priv->program_binary_hits, priv->program_binary_misses);
+
+    if (!priv->program_binaries_dirty)
+        return;
+
+    /* Write to a temporary file first, so that other processes never see a partial cache. */
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", priv->program_binary_path);
+    if ((file = CreateFileA(tmp_path, GENERIC_WRITE, 0, NULL,
+            CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL)) == INVALID_HANDLE_VALUE)
+    {
+        WARN("Failed to create %s, error %lu.\n", debugstr_a(tmp_path), GetLastError());
+        return;
+    }
+
+    header.magic = WINED3D_PROGRAM_BINARY_MAGIC;
+    header.version = WINED3D_PROGRAM_BINARY_VERSION;
+    header.driver_hash = priv->program_binary_driver_hash;
+    header.count = 0;
+    header.padding = 0;
+    WINE_RB_FOR_EACH_ENTRY(binary, &priv->program_binaries, struct glsl_program_binary, entry)
+        ++header.count;
+
+    ret = WriteFile(file, &header, sizeof(header), &written, NULL) && written == sizeof(header);
+    WINE_RB_FOR_EACH_ENTRY(binary, &priv->program_binaries, struct glsl_program_binary, entry)
+    {
+        if (!ret)
+            break;
+        record.hash = binary->hash;
+        record.format = binary->format;
+        record.size = binary->size;
+        ret = WriteFile(file, &record, sizeof(record), &written, NULL) && written == sizeof(record)
+                && WriteFile(file, binary->data, binary->size, &written, NULL) && written == binary->size;
+    }
+    CloseHandle(file);
+
+    if (!ret || !MoveFileExA(tmp_path, priv->program_binary_path, MOVEFILE_REPLACE_EXISTING))
+    {
+        WARN("Failed to write program binary cache %s, error %lu.\n",
+                debugstr_a(priv->program_binary_path), GetLastError());
+        DeleteFileA(tmp_path);
+        return;
+    }
+    TRACE("Saved %u program binaries to %s.\n", header.count, debugstr_a(priv->program_binary_path));
+}
+
+/* The key is derived from the GLSL source of the attached shaders, which in
+ * turn is derived from the shader bytecode and its compile arguments. The
+ * order in which the shaders are attached doesn't matter. */
+static bool shader_glsl_get_program_hash(const struct wined3d_gl_info *gl_info,
+        GLuint program_id, uint64_t seed, uint64_t *hash)
+{
+    GLint i, shader_count, source_size = 0, length;
+    char *source = NULL;
+    GLuint *shaders;
+    uint64_t h;
+    GLint type;
+
+    GL_EXTCALL(glGetProgramiv(program_id, GL_ATTACHED_SHADERS, &shader_count));
+    if (!shader_count || !(shaders = calloc(shader_count, sizeof(*shaders))))
+        return false;
+    GL_EXTCALL(glGetAttachedShaders(program_id, shader_count, NULL, shaders));
+
+    *hash = glsl_hash_data(WINED3D_PROGRAM_HASH_SEED, &seed, sizeof(seed));
+    for (i = 0; i < shader_count; ++i)
+    {
+        GL_EXTCALL(glGetShaderiv(shaders[i], GL_SHADER_SOURCE_LENGTH, &length));
+        if (source_size < length)
+        {
+            free(source);
+            if (!(source = malloc(length)))
+                break;
+            source_size = length;
+        }
+        GL_EXTCALL(glGetShaderSource(shaders[i], source_size, &length, source));
+        GL_EXTCALL(glGetShaderiv(shaders[i], GL_SHADER_TYPE, &type));
+
+        h = glsl_hash_data(WINED3D_PROGRAM_HASH_SEED, &type, sizeof(type));
+        *hash += glsl_hash_data(h, source, length);
+    }
+    checkGLcall("get program hash");
+
+    free(source);
+    free(shaders);
+    return i == shader_count;
+}
+
+/* Context activation is done by the caller. */
+static void shader_glsl_store_program_binary(struct shader_glsl_priv *priv,
+        const struct wined3d_gl_info *gl_info, GLuint program_id, uint64_t hash)
+{
+    struct glsl_program_binary *binary;
+    GLint status, size;
+
+    GL_EXTCALL(glGetProgramiv(program_id, GL_LINK_STATUS, &status));
+    if (!status)
+        return;
+    GL_EXTCALL(glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH, &size));
+    if (size <= 0 || priv->program_binary_size + size > WINED3D_PROGRAM_BINARY_MAX_SIZE)
+        return;
+    if (!(binary = malloc(offsetof(struct glsl_program_binary, data[size]))))
+        return;
+
+    GL_EXTCALL(glGetProgramBinary(program_id, size, &binary->size, &binary->format, binary->data));
+    checkGLcall("glGetProgramBinary");
+    binary->hash = hash;
+    if (!binary->size || !shader_glsl_add_program_binary(priv, binary))
+    {
+        free(binary);
+        return;
+    }
+    priv->program_binaries_dirty = true;
+}
+
+/* Context activation is done by the caller. */
+static void shader_glsl_link_program(struct shader_glsl_priv *priv,
+        const struct wined3d_gl_info *gl_info, GLuint program_id, bool cacheable, uint64_t seed)
+{
+    struct glsl_program_binary *binary;
+    struct wine_rb_entry *entry;
+    uint64_t hash;
+    GLint status;
+
+    TRACE("Linking GLSL shader program %u.\n", program_id);
+
+    if (!priv->program_binary_path || !cacheable
+            || !shader_glsl_get_program_hash(gl_info, program_id, seed, &hash))
+    {
+        GL_EXTCALL(glLinkProgram(program_id));
+        shader_glsl_validate_link(gl_info, program_id);
+        return;
+    }
+
+    if (!priv->program_binaries_loaded)
+    {
+        uint64_t driver_hash = WINED3D_PROGRAM_HASH_SEED;
+
+        /* Binaries are only valid for the driver that produced them. */
+        driver_hash = glsl_hash_string(driver_hash, (const char *)gl_info->gl_ops.gl.p_glGetString(GL_VENDOR));
+        driver_hash = glsl_hash_string(driver_hash, (const char *)gl_info->gl_ops.gl.p_glGetString(GL_RENDERER));
+        driver_hash = glsl_hash_string(driver_hash, (const char *)gl_info->gl_ops.gl.p_glGetString(GL_VERSION));
+        priv->program_binary_driver_hash = driver_hash;
+        shader_glsl_load_program_binaries(priv);
+        priv->program_binaries_loaded = true;
+    }
+
+    if ((entry = wine_rb_get(&priv->program_binaries, &hash)))
+    {
+        binary = WINE_RB_ENTRY_VALUE(entry, struct glsl_program_binary, entry);
+        GL_EXTCALL(glProgramBinary(program_id, binary->format, binary->data, binary->size));
+        GL_EXTCALL(glGetProgramiv(program_id, GL_LINK_STATUS, &status));
+        if (status)
+        {
+            TRACE("Loaded program binary %s for program %u.\n", wine_dbgstr_longlong(hash), program_id);
+            ++priv->program_binary_hits;
+            return;
+        }
+
+        /* The binary was rejected; the attached shaders are still there, so
+         * just link them normally and replace the binary. */
+        WARN("Failed to load program binary %s.\n", wine_dbgstr_longlong(hash));
+        wine_rb_remove(&priv->program_binaries, entry);
+        priv->program_binary_size -= binary->size;
+        priv->program_binaries_dirty = true;
+        free(binary);
+    }
+    ++priv->program_binary_misses;
+
+    GL_EXTCALL(glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+    GL_EXTCALL(glLinkProgram(program_id));
+    shader_glsl_validate_link(gl_info, program_id);
+    shader_glsl_store_program_binary(priv, gl_info, program_id, hash);
+}
+
 static struct vkd3d_shader_resource_binding *create_resource_bindings(const struct wined3d_gl_info *gl_info,
         enum wined3d_shader_type shader_type, unsigned int *count)
 {
@@ -10320,9 +10630,7 @@ static HRESULT shader_glsl_compile_compute_shader(struct shader_glsl_priv *priv,
 
     list_add_head(&shader->linked_programs, &entry->cs.shader_entry);
 
-    TRACE("Linking GLSL shader program %u.\n", program_id);
-    GL_EXTCALL(glLinkProgram(program_id));
-    shader_glsl_validate_link(gl_info, program_id);
+    shader_glsl_link_program(priv, gl_info, program_id, true, 0);
 
     GL_EXTCALL(glUseProgram(program_id));
     checkGLcall("glUseProgram");
@@ -10395,6 +10703,7 @@ static void set_glsl_shader_program(const struct wined3d_context_gl *context_gl,
     GLuint reorder_shader_id = 0;
     struct glsl_program_key key;
     uint32_t attribs_map;
+    uint64_t link_seed;
     GLuint program_id;
     unsigned int i;
     GLuint vs_id = 0;
@@ -10565,6 +10874,12 @@ static void set_glsl_shader_program(const struct wined3d_context_gl *context_gl,
         attribs_map = (1u << WINED3D_FFP_ATTRIBS_COUNT) - 1;
     }
 
+    /* The attribute and fragment output bindings below are not part of the
+     * shader sources. */
+    link_seed = attribs_map;
+    if (state->blend_state && state->blend_state->dual_source)
+        link_seed |= (uint64_t)1 << 32;
+
     if (!shader_glsl_use_explicit_attrib_location(gl_info))
     {
         /* Bind vertex attributes to a corresponding index number to match
@@ -10646,10 +10961,9 @@ static void set_glsl_shader_program(const struct wined3d_context_gl *context_gl,
         list_add_head(ps_list, &entry->ps.shader_entry);
     }
 
-    /* Link the program */
-    TRACE("Linking GLSL shader program %u.\n", program_id);
-    GL_EXTCALL(glLinkProgram(program_id));
-    shader_glsl_validate_link(gl_info, program_id);
+    /* Link the program. Transform feedback varyings are not part of the
+     * program binary key, so programs using them are never cached. */
+    shader_glsl_link_program(priv, gl_info, program_id, !gshader || !gshader->u.gs.so_desc, link_seed);
 
     shader_glsl_init_vs_uniform_locations(gl_info, priv, program_id, &entry->vs,
             vshader ? vshader->limits->constant_float : 0);
@@ -11204,6 +11518,25 @@ static void constant_free(struct constant_heap *heap)
     free(heap->entries);
 }
 
+static void shader_glsl_init_program_binaries(struct shader_glsl_priv *priv, const struct wined3d_adapter *adapter)
+{
+    const struct wined3d_gl_info *gl_info = &wined3d_adapter_gl_const(adapter)->gl_info;
+    char app_name[MAX_PATH], path[MAX_PATH];
+    int len;
+
+    wine_rb_init(&priv->program_binaries, glsl_program_binary_compare);
+
+    if (!wined3d_settings.pipeline_cache_path || !gl_info->supported[ARB_GET_PROGRAM_BINARY])
+        return;
+    if (!wined3d_get_app_name(app_name, ARRAY_SIZE(app_name)))
+        strcpy(app_name, "wined3d");
+
+    len = snprintf(path, sizeof(path), "%s\\%s.%04x-%04x.glcache", wined3d_settings.pipeline_cache_path,
+            app_name, adapter->driver_info.vendor, adapter->driver_info.device);
+    if (len > 0 && len < (int)sizeof(path))
+        priv->program_binary_path = strdup(path);
+}
+
 static HRESULT shader_glsl_alloc(struct wined3d_device *device, const struct wined3d_vertex_pipe_ops *vertex_pipe,
         const struct wined3d_fragment_pipe_ops *fragment_pipe)
 {
@@ -11262,6 +11595,7 @@ static HRESULT shader_glsl_alloc(struct wined3d_device *device, const struct win
     }
 
     wine_rb_init(&priv->program_lookup, glsl_program_key_compare);
+    shader_glsl_init_program_binaries(priv, device->adapter);
 
     priv->next_constant_version = 1;
     priv->vertex_pipe = vertex_pipe;
@@ -11290,6 +11624,10 @@ static void shader_glsl_free(struct wined3d_device *device, struct wined3d_conte
 {
     struct shader_glsl_priv *priv = device->shader_priv;
 
+    if (priv->program_binary_path)
+        shader_glsl_save_program_binaries(priv);
+    wine_rb_destroy(&priv->program_binaries, glsl_free_program_binary, NULL);
+    free(priv->program_binary_path);
     wine_rb_destroy(&priv->program_lookup, NULL, NULL);
     constant_free(&priv->pconst_heap);
     constant_free(&priv->vconst_heap);
@@ -71,6 +71,19 @@ struct shader_spirv_compile_arguments
     } u;
 };
 
+struct shader_spirv_compile_job
+{
+    struct wined3d_device_vk *device_vk;
+    struct wined3d_shader_desc shader_desc;
+    enum vkd3d_shader_source_type source_type;
+    enum wined3d_shader_type shader_type;
+    struct shader_spirv_compile_arguments args;
+    struct shader_spirv_resource_bindings bindings;
+
+    HANDLE event;
+    VkShaderModule vk_module;
+};
+
 struct shader_spirv_graphics_program_variant_vk
 {
     struct shader_spirv_compile_arguments compile_args;
@@ -78,6 +91,7 @@ struct shader_spirv_graphics_program_variant_vk
     size_t binding_base;
 
     VkShaderModule vk_module;
+    struct shader_spirv_compile_job *job;
 };
 
 struct shader_spirv_graphics_program_vk
@@ -346,12 +360,11 @@ static void shader_spirv_init_shader_interface_vk(struct wined3d_shader_spirv_sh
     iface->vkd3d_interface.uav_counter_count = b->uav_counter_count;
 }
 
-static VkShaderModule shader_spirv_compile_shader(struct wined3d_context_vk *context_vk,
+static VkShaderModule shader_spirv_compile_shader(struct wined3d_device_vk *device_vk,
         const struct wined3d_shader_desc *shader_desc, enum vkd3d_shader_source_type source_type,
         enum wined3d_shader_type shader_type, const struct shader_spirv_compile_arguments *args,
         const struct shader_spirv_resource_bindings *bindings, const struct wined3d_stream_output_desc *so_desc)
 {
-    struct wined3d_device_vk *device_vk = wined3d_device_vk(context_vk->c.device);
     const struct shader_spirv_priv *priv = device_vk->d.shader_priv;
     const struct wined3d_vk_info *vk_info = &device_vk->vk_info;
     struct wined3d_shader_spirv_compile_args compile_args;
@@ -418,10 +431,94 @@ static VkShaderModule shader_spirv_compile_shader(struct wined3d_context_vk *con
     return module;
 }
 
+static void shader_spirv_compile_job_destroy(struct shader_spirv_compile_job *job)
+{
+    CloseHandle(job->event);
+    free(job->bindings.bindings);
+    free(job);
+}
+
+static void CALLBACK shader_spirv_compile_job_run(TP_CALLBACK_INSTANCE *instance, void *ctx)
+{
+    struct shader_spirv_compile_job *job = ctx;
+
+    job->vk_module = shader_spirv_compile_shader(job->device_vk, &job->shader_desc,
+            job->source_type, job->shader_type, &job->args, &job->bindings, NULL);
+    SetEvent(job->event);
+}
+
+static struct shader_spirv_compile_job *shader_spirv_compile_job_create(struct wined3d_device_vk *device_vk,
+        const struct wined3d_shader_desc *shader_desc, enum vkd3d_shader_source_type source_type,
+        enum wined3d_shader_type shader_type, const struct shader_spirv_compile_arguments *args,
+        const struct shader_spirv_resource_bindings *bindings)
+{
+    struct shader_spirv_compile_job *job;
+    size_t size;
+
+    if (!(job = calloc(1, sizeof(*job))))
+        return NULL;
+
+    job->device_vk = device_vk;
+    job->shader_desc = *shader_desc;
+    job->source_type = source_type;
+    job->shader_type = shader_type;
+    job->args = *args;
+
+    /* The bindings are rebuilt for every draw; the job needs its own copy. */
+    size = bindings->binding_count * sizeof(*bindings->bindings);
+    if (size && !(job->bindings.bindings = malloc(size)))
+    {
+        free(job);
+        return NULL;
+    }
+    if (size)
+        memcpy(job->bindings.bindings, bindings->bindings, size);
+    job->bindings.bindings_size = job->bindings.binding_count = bindings->binding_count;
+    memcpy(job->bindings.uav_counters, bindings->uav_counters, sizeof(bindings->uav_counters));
+    job->bindings.uav_counter_count = bindings->uav_counter_count;
+    job->bindings.ffp_ps_extra_binding = bindings->ffp_ps_extra_binding;
+    job->bindings.ffp_vs_extra_binding = bindings->ffp_vs_extra_binding;
+
+    if (!(job->event = CreateEventW(NULL, TRUE, FALSE, NULL)))
+    {
+        free(job->bindings.bindings);
+        free(job);
+        return NULL;
+    }
+
+    if (!TrySubmitThreadpoolCallback(shader_spirv_compile_job_run, job, NULL))
+    {
+        ERR("Failed to submit shader compilation job, error %lu.\n", GetLastError());
+        shader_spirv_compile_job_destroy(job);
+        return NULL;
+    }
+
+    return job;
+}
+
+/* Returns false while the variant's shader module is still being compiled. */
+static bool shader_spirv_graphics_program_variant_vk_ready(struct shader_spirv_graphics_program_variant_vk *variant_vk,
+        unsigned int timeout)
+{
+    struct shader_spirv_compile_job *job;
+
+    if (!(job = variant_vk->job))
+        return true;
+
+    if (WaitForSingleObject(job->event, timeout))
+        return false;
+
+    variant_vk->vk_module = job->vk_module;
+    variant_vk->job = NULL;
+    shader_spirv_compile_job_destroy(job);
+    return true;
+}
+
 static struct shader_spirv_graphics_program_variant_vk *shader_spirv_find_graphics_program_variant_vk(
         struct shader_spirv_priv *priv, struct wined3d_context_vk *context_vk, struct wined3d_shader *shader,
-        const struct wined3d_state *state, const struct shader_spirv_resource_bindings *bindings)
+        const struct wined3d_state *state, const struct shader_spirv_resource_bindings *bindings, bool *pending)
 {
+    struct wined3d_device_vk *device_vk = wined3d_device_vk(context_vk->c.device);
     enum wined3d_shader_type shader_type = shader->reg_maps.shader_version.type;
     struct shader_spirv_graphics_program_variant_vk *variant_vk;
     size_t binding_base = bindings->binding_base[shader_type];
@@ -431,6 +528,7 @@ static struct shader_spirv_graphics_program_variant_vk *shader_spirv_find_graphi
     struct wined3d_shader_desc shader_desc;
     size_t variant_count, i;
 
+    *pending = false;
     shader_spirv_compile_arguments_init(&args, &context_vk->c, shader, state, context_vk->sample_count);
     if (bindings->so_stage == shader_type)
         so_desc = state->shader[WINED3D_SHADER_TYPE_GEOMETRY]->u.gs.so_desc;
@@ -444,7 +542,14 @@ static struct shader_spirv_graphics_program_variant_vk *shader_spirv_find_graphi
         variant_vk = &program_vk->variants[i];
         if (variant_vk->so_desc == so_desc && variant_vk->binding_base == binding_base
                 && !memcmp(&variant_vk->compile_args, &args, sizeof(args)))
-            return variant_vk;
+        {
+            if (!shader_spirv_graphics_program_variant_vk_ready(variant_vk, wined3d_settings.async_shader_compile))
+            {
+                *pending = true;
+                return NULL;
+            }
+            return variant_vk->vk_module ? variant_vk : NULL;
+        }
     }
 
     if (!wined3d_array_reserve((void **)&program_vk->variants, &program_vk->variants_size,
@@ -453,7 +558,10 @@ static struct shader_spirv_graphics_program_variant_vk *shader_spirv_find_graphi
 
     variant_vk = &program_vk->variants[variant_count];
     variant_vk->compile_args = args;
+    variant_vk->so_desc = so_desc;
     variant_vk->binding_base = binding_base;
+    variant_vk->vk_module = VK_NULL_HANDLE;
+    variant_vk->job = NULL;
 
     if (shader->source_type == VKD3D_SHADER_SOURCE_D3D_BYTECODE)
     {
@@ -466,7 +574,22 @@ static struct shader_spirv_graphics_program_variant_vk *shader_spirv_find_graphi
         shader_desc.byte_code_size = shader->byte_code_size;
     }
 
-    if (!(variant_vk->vk_module = shader_spirv_compile_shader(context_vk, &shader_desc,
+    /* Stream output descriptions belong to the geometry shader, which may be
+     * destroyed before a background compile finishes. */
+    if (wined3d_settings.async_shader_compile != ~0u && !so_desc
+            && (variant_vk->job = shader_spirv_compile_job_create(device_vk, &shader_desc,
+            shader->source_type, shader_type, &args, bindings)))
+    {
+        ++program_vk->variant_count;
+        if (!shader_spirv_graphics_program_variant_vk_ready(variant_vk, wined3d_settings.async_shader_compile))
+        {
+            *pending = true;
+            return NULL;
+        }
+        return variant_vk->vk_module ? variant_vk : NULL;
+    }
+
+    if (!(variant_vk->vk_module = shader_spirv_compile_shader(device_vk, &shader_desc,
             shader->source_type, shader_type, &args, bindings, so_desc)))
         return NULL;
     ++program_vk->variant_count;
@@ -495,7 +618,7 @@ static struct shader_spirv_compute_program_vk *shader_spirv_find_compute_program
     shader_desc.byte_code = shader->byte_code;
     shader_desc.byte_code_size = shader->byte_code_size;
 
-    if (!(program->vk_module = shader_spirv_compile_shader(context_vk, &shader_desc,
+    if (!(program->vk_module = shader_spirv_compile_shader(device_vk, &shader_desc,
             shader->source_type, WINED3D_SHADER_TYPE_COMPUTE, NULL, bindings, NULL)))
         return NULL;
 
@@ -522,8 +645,7 @@ static struct shader_spirv_compute_program_vk *shader_spirv_find_compute_program
     pipeline_info.layout = program->vk_pipeline_layout;
     pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
     pipeline_info.basePipelineIndex = -1;
-    if ((vr = VK_CALL(vkCreateComputePipelines(device_vk->vk_device,
-            VK_NULL_HANDLE, 1, &pipeline_info, NULL, &program->vk_pipeline))) < 0)
+    if ((vr = wined3d_device_vk_create_compute_pipeline(device_vk, &pipeline_info, &program->vk_pipeline)) < 0)
     {
         ERR("Failed to create Vulkan compute pipeline, vr %s.\n", wined3d_debug_vkresult(vr));
         VK_CALL(vkDestroyShaderModule(device_vk->vk_device, program->vk_module, NULL));
@@ -931,7 +1053,9 @@ static void shader_spirv_apply_draw_state(void *shader_priv, struct wined3d_cont
     struct shader_spirv_priv *priv = shader_priv;
     enum wined3d_shader_type shader_type;
     struct wined3d_shader *shader;
+    bool pending;
 
+    context_vk->graphics.shaders_pending = false;
     priv->vertex_pipe->vp_apply_draw_state(context, state);
     priv->fragment_pipe->fp_apply_draw_state(context, state);
 
@@ -962,8 +1086,18 @@ static void shader_spirv_apply_draw_state(void *shader_priv, struct wined3d_cont
             continue;
         }
 
-        if (!(variant_vk = shader_spirv_find_graphics_program_variant_vk(priv, context_vk, shader, state, bindings)))
+        if (!(variant_vk = shader_spirv_find_graphics_program_variant_vk(priv,
+                context_vk, shader, state, bindings, &pending)))
+        {
+            /* Keep going, so that the remaining stages start compiling as well. */
+            context_vk->graphics.vk_modules[shader_type] = VK_NULL_HANDLE;
+            if (pending)
+            {
+                context_vk->graphics.shaders_pending = true;
+                continue;
+            }
             goto fail;
+        }
         context_vk->graphics.vk_modules[shader_type] = variant_vk->vk_module;
     }
 
@@ -1115,6 +1249,7 @@ static void shader_spirv_destroy(struct wined3d_shader *shader)
     for (i = 0; i < program_vk->variant_count; ++i)
     {
         variant_vk = &program_vk->variants[i];
+        shader_spirv_graphics_program_variant_vk_ready(variant_vk, INFINITE);
         shader_spirv_invalidate_contexts_graphics_program_variant(&device_vk->d, variant_vk);
         VK_CALL(vkDestroyShaderModule(device_vk->vk_device, variant_vk->vk_module, NULL));
     }
@@ -1222,7 +1357,7 @@ static uint64_t shader_spirv_compile(struct wined3d_context *context, const stru
         enum wined3d_shader_type shader_type)
 {
     struct shader_spirv_resource_bindings bindings = {0};
-    return (uint64_t)shader_spirv_compile_shader(wined3d_context_vk(context), shader_desc,
+    return (uint64_t)shader_spirv_compile_shader(wined3d_device_vk(context->device), shader_desc,
             VKD3D_SHADER_SOURCE_DXBC_TPF, shader_type, NULL, &bindings, NULL);
 }
 
@@ -127,6 +127,7 @@ struct wined3d_settings wined3d_settings =
     .max_sm_hs = UINT_MAX,
     .max_sm_gs = UINT_MAX,
     .max_sm_cs = UINT_MAX,
+    .async_shader_compile = ~0u,
     .renderer = WINED3D_RENDERER_AUTO,
     .shader_backend = WINED3D_SHADER_BACKEND_AUTO,
     .decoder_backend = WINED3D_DECODER_BACKEND_AUTO,
@@ -429,6 +430,11 @@ static BOOL wined3d_dll_init(HINSTANCE hInstDLL)
             else
                 memcpy(wined3d_settings.logo, buffer, len);
         }
+        if (!get_config_key(hkey, appkey, env, "PipelineCachePath", buffer, size) && *buffer)
+        {
+            ERR_(winediag)("Storing pipeline caches in %s.\n", debugstr_a(buffer));
+            wined3d_settings.pipeline_cache_path = strdup(buffer);
+        }
         if (!get_config_key_dword(hkey, appkey, env, "MultisampleTextures", &wined3d_settings.multisample_textures))
             ERR_(winediag)("Setting multisample textures to %#x.\n", wined3d_settings.multisample_textures);
         if (!get_config_key_dword(hkey, appkey, env, "SampleCount", &wined3d_settings.sample_count))
@@ -454,6 +460,9 @@ static BOOL wined3d_dll_init(HINSTANCE hInstDLL)
             TRACE("Limiting PS shader model to %u.\n", wined3d_settings.max_sm_ps);
         if (!get_config_key_dword(hkey, appkey, env, "MaxShaderModelCS", &wined3d_settings.max_sm_cs))
             TRACE("Limiting CS shader model to %u.\n", wined3d_settings.max_sm_cs);
+        if (!get_config_key_dword(hkey, appkey, env, "AsyncShaderCompile", &wined3d_settings.async_shader_compile))
+            ERR_(winediag)("Compiling shaders asynchronously, draws wait at most %u ms for them.\n",
+                    wined3d_settings.async_shader_compile);
         if (!get_config_key(hkey, appkey, env, "renderer", buffer, size))
         {
             if (!strcmp(buffer, "vulkan"))
@@ -541,6 +550,7 @@ static BOOL wined3d_dll_destroy(HINSTANCE hInstDLL)
     free(swapchain_state_table.hooks);
 
     free(wined3d_settings.logo);
+    free(wined3d_settings.pipeline_cache_path);
     UnregisterClassA(WINED3D_OPENGL_WINDOW_CLASS_NAME, hInstDLL);
 
     DeleteCriticalSection(&wined3d_command_cs);
@@ -478,6 +478,7 @@ struct wined3d_settings
     /* Memory tracking and object counting. */
     UINT64 emulated_textureram;
     char *logo;
+    char *pipeline_cache_path;
     unsigned int multisample_textures;
     unsigned int sample_count;
     unsigned int strict_shader_math;
@@ -487,6 +488,9 @@ struct wined3d_settings
     unsigned int max_sm_gs;
     unsigned int max_sm_ps;
     unsigned int max_sm_cs;
+    /* Maximum time in milliseconds a draw waits for a shader being compiled
+     * in the background, or ~0u to compile shaders synchronously. */
+    unsigned int async_shader_compile;
     enum wined3d_renderer renderer;
     enum wined3d_shader_backend shader_backend;
     enum wined3d_decoder_backend decoder_backend;
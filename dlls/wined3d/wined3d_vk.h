@@ -256,6 +256,7 @@ enum wined3d_vk_extension
     WINED3D_VK_EXT_EXTENDED_DYNAMIC_STATE2,
     WINED3D_VK_EXT_EXTENDED_DYNAMIC_STATE3,
     WINED3D_VK_EXT_HOST_QUERY_RESET,
+    WINED3D_VK_EXT_PIPELINE_CREATION_FEEDBACK,
     WINED3D_VK_EXT_SAMPLER_FILTER_MINMAX,
     WINED3D_VK_EXT_SHADER_STENCIL_EXPORT,
     WINED3D_VK_EXT_TRANSFORM_FEEDBACK,
@@ -687,6 +688,7 @@ struct wined3d_context_vk
     struct
     {
         VkShaderModule vk_modules[WINED3D_SHADER_TYPE_GRAPHICS_COUNT];
+        bool shaders_pending;
         struct wined3d_graphics_pipeline_key_vk pipeline_key_vk;
         VkPipeline vk_pipeline;
         VkPipelineLayout vk_pipeline_layout;
@@ -947,6 +949,10 @@ struct wined3d_device_vk
     struct wined3d_allocator allocator;
 
     struct wined3d_uav_clear_state_vk uav_clear_state;
+
+    VkPipelineCache vk_pipeline_cache;
+    unsigned int pipeline_cache_hits;
+    unsigned int pipeline_cache_misses;
 };
 
 static inline struct wined3d_device_vk *wined3d_device_vk(struct wined3d_device *device)
@@ -978,6 +984,12 @@ void wined3d_device_vk_destroy_null_resources(struct wined3d_device_vk *device_v
 void wined3d_device_vk_destroy_null_views(struct wined3d_device_vk *device_vk,
         struct wined3d_context_vk *context_vk);
 
+void wined3d_device_vk_create_pipeline_cache(struct wined3d_device_vk *device_vk, VkPhysicalDevice physical_device);
+void wined3d_device_vk_destroy_pipeline_cache(struct wined3d_device_vk *device_vk, VkPhysicalDevice physical_device);
+VkResult wined3d_device_vk_create_compute_pipeline(struct wined3d_device_vk *device_vk,
+        const VkComputePipelineCreateInfo *create_info, VkPipeline *pipeline);
+VkResult wined3d_device_vk_create_graphics_pipeline(struct wined3d_device_vk *device_vk,
+        const VkGraphicsPipelineCreateInfo *create_info, VkPipeline *pipeline);
 void wined3d_device_vk_uav_clear_state_init(struct wined3d_device_vk *device_vk);
 void wined3d_device_vk_uav_clear_state_cleanup(struct wined3d_device_vk *device_vk);
 
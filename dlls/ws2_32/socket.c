@@ -27,6 +27,7 @@
  */
 
 #include "ws2_32_private.h"
+#include "wine/list.h"
 
 #define FILE_USE_FILE_POINTER_POSITION ((LONGLONG)-2)
 
@@ -1199,6 +1200,819 @@ static int WS2_sendto( SOCKET s, WSABUF *buffers, DWORD buffer_count, DWORD *ret
 }
 
 
+/* Registered I/O is implemented on top of overlapped I/O. Each request signals
+ * its own event, with the low bit set so that nothing is posted to a completion
+ * port the application may have associated with the socket, and the completion
+ * is collected from a thread pool wait callback.
+ *
+ * On datagram sockets the requests are instead gathered into batches, so that
+ * up to RIO_BATCH_SIZE datagrams are transferred with a single server call and
+ * a single recvmmsg() or sendmmsg() call. Each direction has at most one batch
+ * in progress; requests committed meanwhile wait for the next one. */
+
+#define RIO_MAX_DATA_BUFFERS 1024  /* maximum number of data buffers per request */
+#define RIO_BATCH_SIZE         64  /* maximum number of datagrams per batch */
+
+struct rio_buffer
+{
+    char  *data;
+    DWORD  size;
+};
+
+struct rio_cq
+{
+    CRITICAL_SECTION cs;
+    RIORESULT       *results;   /* ring buffer of completion results */
+    DWORD            size;      /* size of the ring buffer */
+    DWORD            head;      /* index of the first result */
+    DWORD            count;     /* number of results in the ring buffer */
+    DWORD            pending;   /* number of requests not completed yet */
+    BOOL             notify;    /* notification requested with RIONotify */
+    BOOL             closed;    /* closed while requests were pending, freed once they complete */
+    RIO_NOTIFICATION_COMPLETION notification;
+};
+
+struct rio_batch
+{
+    IO_STATUS_BLOCK  io;
+    struct rio_rq   *rq;
+    HANDLE           event;
+    TP_WAIT         *wait;
+    BOOL             send;
+    BOOL             active;    /* a batch is in progress */
+    struct list      queue;     /* requests waiting for the next batch */
+    ULONG            count;     /* number of requests in the current batch */
+    struct rio_request *requests[RIO_BATCH_SIZE];
+    struct afd_mmsg_params params[RIO_BATCH_SIZE];
+    struct afd_iovec iov[1];
+};
+
+struct rio_rq
+{
+    struct list      entry;     /* entry in the request queue list */
+    LONG             refcount;
+    CRITICAL_SECTION cs;
+    SOCKET           socket;
+    void            *context;
+    struct rio_cq   *recv_cq;
+    struct rio_cq   *send_cq;
+    ULONG            max_recv;  /* maximum number of outstanding receives */
+    ULONG            max_send;  /* maximum number of outstanding sends */
+    ULONG            max_recv_buffers; /* maximum number of buffers per receive */
+    ULONG            max_send_buffers; /* maximum number of buffers per send */
+    LONG             num_recv;  /* number of outstanding receives */
+    LONG             num_send;  /* number of outstanding sends */
+    struct list      deferred_recv; /* receives queued with RIO_MSG_DEFER */
+    struct list      deferred_send; /* sends queued with RIO_MSG_DEFER */
+    struct list      free;      /* requests available for reuse */
+    struct rio_batch *recv_batch; /* receive batch, for datagram sockets */
+    struct rio_batch *send_batch; /* send batch, for datagram sockets */
+};
+
+struct rio_request
+{
+    struct list      entry;     /* entry in the deferred, batch or free list */
+    OVERLAPPED       ovl;
+    struct rio_rq   *rq;
+    HANDLE           event;
+    TP_WAIT         *wait;
+    void            *context;
+    BOOL             send;
+    DWORD            flags;
+    DWORD            recv_flags;
+    struct sockaddr *addr;
+    int              addr_len;
+    ULONG            count;
+    WSABUF           buffers[1];
+};
+
+static struct list rio_rq_list = LIST_INIT( rio_rq_list );
+DECLARE_CRITICAL_SECTION(cs_rio_rq_list);
+
+static struct rio_cq *rio_request_cq( const struct rio_request *request )
+{
+    return request->send ? request->rq->send_cq : request->rq->recv_cq;
+}
+
+static void rio_destroy_request( struct rio_request *request )
+{
+    if (request->wait) TpReleaseWait( request->wait );
+    if (request->event) CloseHandle( request->event );
+    free( request );
+}
+
+static void rio_destroy_cq( struct rio_cq *cq )
+{
+    cq->cs.DebugInfo->Spare[0] = 0;
+    DeleteCriticalSection( &cq->cs );
+    free( cq->results );
+    free( cq );
+}
+
+static void rio_destroy_batch( struct rio_batch *batch )
+{
+    if (!batch) return;
+    if (batch->wait) TpReleaseWait( batch->wait );
+    if (batch->event) CloseHandle( batch->event );
+    free( batch );
+}
+
+/* discard requests that were deferred and never committed */
+static void rio_discard_deferred( struct list *deferred )
+{
+    struct rio_request *request, *next;
+    struct rio_cq *cq;
+    BOOL destroy;
+
+    LIST_FOR_EACH_ENTRY_SAFE( request, next, deferred, struct rio_request, entry )
+    {
+        cq = rio_request_cq( request );
+        EnterCriticalSection( &cq->cs );
+        destroy = !--cq->pending && cq->closed;
+        LeaveCriticalSection( &cq->cs );
+        if (destroy) rio_destroy_cq( cq );
+        list_remove( &request->entry );
+        rio_destroy_request( request );
+    }
+}
+
+static void rio_rq_release( struct rio_rq *rq )
+{
+    struct rio_request *request, *next;
+
+    if (InterlockedDecrement( &rq->refcount )) return;
+    rio_discard_deferred( &rq->deferred_recv );
+    rio_discard_deferred( &rq->deferred_send );
+    LIST_FOR_EACH_ENTRY_SAFE( request, next, &rq->free, struct rio_request, entry )
+        rio_destroy_request( request );
+    rio_destroy_batch( rq->recv_batch );
+    rio_destroy_batch( rq->send_batch );
+    rq->cs.DebugInfo->Spare[0] = 0;
+    DeleteCriticalSection( &rq->cs );
+    free( rq );
+}
+
+/* release the request queue associated with a socket being closed */
+static void rio_close_socket( SOCKET s )
+{
+    struct rio_rq *rq;
+
+    EnterCriticalSection( &cs_rio_rq_list );
+    LIST_FOR_EACH_ENTRY( rq, &rio_rq_list, struct rio_rq, entry )
+    {
+        if (rq->socket != s) continue;
+        list_remove( &rq->entry );
+        LeaveCriticalSection( &cs_rio_rq_list );
+        rio_rq_release( rq );
+        return;
+    }
+    LeaveCriticalSection( &cs_rio_rq_list );
+}
+
+static void rio_cq_notify( struct rio_cq *cq )
+{
+    if (cq->notification.Type == RIO_EVENT_COMPLETION)
+        SetEvent( cq->notification.Event.EventHandle );
+    else
+        PostQueuedCompletionStatus( cq->notification.Iocp.IocpHandle, 0,
+                                    (ULONG_PTR)cq->notification.Iocp.CompletionKey,
+                                    cq->notification.Iocp.Overlapped );
+}
+
+static void rio_free_request( struct rio_request *request )
+{
+    struct rio_rq *rq = request->rq;
+
+    EnterCriticalSection( &rq->cs );
+    list_add_head( &rq->free, &request->entry );
+    LeaveCriticalSection( &rq->cs );
+}
+
+/* add the result of a request to its completion queue and release it */
+static void rio_complete_request( struct rio_request *request, LONG error, ULONG_PTR size )
+{
+    struct rio_rq *rq = request->rq;
+    struct rio_cq *cq = rio_request_cq( request );
+    RIORESULT *result;
+    BOOL destroy;
+
+    TRACE( "request %p, error %ld, size %Iu\n", request, error, size );
+
+    EnterCriticalSection( &cq->cs );
+    if (!cq->closed)
+    {
+        result = &cq->results[(cq->head + cq->count++) % cq->size];
+        result->Status = error;
+        result->BytesTransferred = size;
+        result->SocketContext = (ULONG_PTR)rq->context;
+        result->RequestContext = (ULONG_PTR)request->context;
+        if (cq->notify && !(request->flags & RIO_MSG_DONT_NOTIFY))
+        {
+            cq->notify = FALSE;
+            rio_cq_notify( cq );
+        }
+    }
+    destroy = !--cq->pending && cq->closed;
+    LeaveCriticalSection( &cq->cs );
+    if (destroy) rio_destroy_cq( cq );
+
+    InterlockedDecrement( request->send ? &rq->num_send : &rq->num_recv );
+    rio_free_request( request );
+    rio_rq_release( rq );
+}
+
+static void CALLBACK rio_wait_callback( TP_CALLBACK_INSTANCE *instance, void *userdata, TP_WAIT *wait,
+                                        TP_WAIT_RESULT result )
+{
+    struct rio_request *request = userdata;
+
+    rio_complete_request( request, NtStatusToWSAError( request->ovl.Internal ), request->ovl.InternalHigh );
+}
+
+/* take the queued requests into the batch, which holds a reference to the queue until it completes */
+static BOOL rio_fill_batch( struct rio_batch *batch )
+{
+    struct rio_rq *rq = batch->rq;
+    struct afd_iovec *iov = batch->iov;
+    struct afd_mmsg_params *params;
+    struct rio_request *request;
+    struct list *entry;
+    ULONG i;
+
+    EnterCriticalSection( &rq->cs );
+    if (batch->active || list_empty( &batch->queue ))
+    {
+        LeaveCriticalSection( &rq->cs );
+        return FALSE;
+    }
+    batch->active = TRUE;
+    batch->count = 0;
+    while (batch->count < RIO_BATCH_SIZE && (entry = list_head( &batch->queue )))
+    {
+        list_remove( entry );
+        request = LIST_ENTRY( entry, struct rio_request, entry );
+        batch->requests[batch->count] = request;
+        params = &batch->params[batch->count++];
+        params->addr_ptr = u64_from_user_ptr( request->addr );
+        params->iov_ptr = u64_from_user_ptr( iov );
+        params->iov_count = request->count;
+        params->addr_len = request->addr_len;
+        params->status = STATUS_PENDING;
+        params->size = 0;
+        for (i = 0; i < request->count; i++, iov++)
+        {
+            iov->ptr = u64_from_user_ptr( request->buffers[i].buf );
+            iov->len = request->buffers[i].len;
+        }
+    }
+    LeaveCriticalSection( &rq->cs );
+
+    InterlockedIncrement( &rq->refcount );
+    return TRUE;
+}
+
+/* complete the requests transferred by the batch and queue the others again */
+static void rio_finish_batch( struct rio_batch *batch, NTSTATUS status, ULONG_PTR done )
+{
+    struct rio_rq *rq = batch->rq;
+    ULONG i, count = batch->count;
+
+    TRACE( "batch %p, status %#lx, %Iu/%lu transferred\n", batch, status, done, count );
+
+    if (NT_ERROR( status ))
+    {
+        /* the error belongs to the first datagram, unless the socket itself is gone */
+        done = (status == STATUS_CANCELLED || status == STATUS_INVALID_HANDLE) ? count : 1;
+        for (i = 0; i < done; i++)
+        {
+            batch->params[i].status = status;
+            batch->params[i].size = 0;
+        }
+    }
+    done = min( done, count );
+
+    for (i = 0; i < done; i++)
+        rio_complete_request( batch->requests[i], NtStatusToWSAError( batch->params[i].status ),
+                              batch->params[i].size );
+
+    EnterCriticalSection( &rq->cs );
+    for (i = count; i > done; i--) list_add_head( &batch->queue, &batch->requests[i - 1]->entry );
+    batch->active = FALSE;
+    LeaveCriticalSection( &rq->cs );
+}
+
+/* start a batch if none is in progress, errors are reported through the completion queue */
+static void rio_submit_batch( struct rio_batch *batch )
+{
+    struct rio_rq *rq = batch->rq;
+    NTSTATUS status;
+
+    while (rio_fill_batch( batch ))
+    {
+        status = NtDeviceIoControlFile( (HANDLE)rq->socket, batch->event, NULL, NULL, &batch->io,
+                                        batch->send ? IOCTL_AFD_WINE_SENDMMSG : IOCTL_AFD_WINE_RECVMMSG,
+                                        batch->params, batch->count * sizeof(*batch->params), NULL, 0 );
+        if (!NT_ERROR( status ))
+        {
+            TpSetWait( batch->wait, batch->event, NULL );
+            return;
+        }
+        /* the event is not signaled for immediate failures */
+        rio_finish_batch( batch, status, 0 );
+        rio_rq_release( rq );
+    }
+}
+
+static void CALLBACK rio_batch_callback( TP_CALLBACK_INSTANCE *instance, void *userdata, TP_WAIT *wait,
+                                         TP_WAIT_RESULT result )
+{
+    struct rio_batch *batch = userdata;
+    struct rio_rq *rq = batch->rq;
+
+    rio_finish_batch( batch, batch->io.Status, batch->io.Information );
+    rio_submit_batch( batch );
+    rio_rq_release( rq );
+}
+
+static struct rio_batch *rio_create_batch( struct rio_rq *rq, ULONG max_buffers, BOOL send )
+{
+    struct rio_batch *batch;
+
+    if (!(batch = calloc( 1, offsetof( struct rio_batch, iov[RIO_BATCH_SIZE * max( max_buffers, 1 )] ) )))
+        return NULL;
+    batch->rq = rq;
+    batch->send = send;
+    list_init( &batch->queue );
+    if (!(batch->event = CreateEventW( NULL, FALSE, FALSE, NULL )) ||
+        TpAllocWait( &batch->wait, rio_batch_callback, batch, NULL ))
+    {
+        batch->wait = NULL;
+        rio_destroy_batch( batch );
+        return NULL;
+    }
+    return batch;
+}
+
+static struct rio_request *rio_alloc_request( struct rio_rq *rq )
+{
+    ULONG count = max( max( rq->max_recv_buffers, rq->max_send_buffers ), 1 );
+    struct rio_request *request = NULL;
+    struct list *entry;
+
+    EnterCriticalSection( &rq->cs );
+    if ((entry = list_head( &rq->free )))
+    {
+        list_remove( entry );
+        request = LIST_ENTRY( entry, struct rio_request, entry );
+    }
+    LeaveCriticalSection( &rq->cs );
+    if (request) return request;
+
+    if (!(request = calloc( 1, offsetof( struct rio_request, buffers[count] ) ))) return NULL;
+    request->rq = rq;
+    if (!(request->event = CreateEventW( NULL, FALSE, FALSE, NULL )) ||
+        TpAllocWait( &request->wait, rio_wait_callback, request, NULL ))
+    {
+        request->wait = NULL;
+        rio_destroy_request( request );
+        return NULL;
+    }
+    return request;
+}
+
+/* start the I/O for a request, which holds a reference to the queue until it completes */
+static DWORD rio_start_request( struct rio_request *request )
+{
+    struct rio_rq *rq = request->rq;
+    DWORD error;
+    int ret;
+
+    memset( &request->ovl, 0, sizeof(request->ovl) );
+    request->ovl.hEvent = (HANDLE)((ULONG_PTR)request->event | 1);
+    if (request->send)
+        ret = WS2_sendto( rq->socket, request->buffers, request->count, NULL, 0, request->addr,
+                          request->addr_len, &request->ovl, NULL );
+    else
+    {
+        request->recv_flags = (request->flags & RIO_MSG_WAITALL) ? MSG_WAITALL : 0;
+        ret = WS2_recv_base( rq->socket, request->buffers, request->count, NULL, &request->recv_flags,
+                             request->addr, request->addr ? &request->addr_len : NULL,
+                             &request->ovl, NULL, NULL );
+    }
+    if (ret && (error = GetLastError()) != WSA_IO_PENDING) return error;
+
+    InterlockedIncrement( &rq->refcount );
+    TpSetWait( request->wait, request->event, NULL );
+    return 0;
+}
+
+/* start the requests queued with RIO_MSG_DEFER; their errors are reported through the completion queue */
+static void rio_commit_deferred( struct rio_rq *rq, BOOL send )
+{
+    struct list *deferred = send ? &rq->deferred_send : &rq->deferred_recv;
+    struct rio_batch *batch = send ? rq->send_batch : rq->recv_batch;
+    struct rio_request *request, *next;
+    struct list list = LIST_INIT( list );
+    DWORD error;
+
+    EnterCriticalSection( &rq->cs );
+    if (batch)
+    {
+        LIST_FOR_EACH_ENTRY( request, deferred, struct rio_request, entry )
+            InterlockedIncrement( &rq->refcount );
+        list_move_tail( &batch->queue, deferred );
+    }
+    else list_move_tail( &list, deferred );
+    LeaveCriticalSection( &rq->cs );
+
+    if (batch)
+    {
+        rio_submit_batch( batch );
+        return;
+    }
+
+    LIST_FOR_EACH_ENTRY_SAFE( request, next, &list, struct rio_request, entry )
+    {
+        list_remove( &request->entry );
+        if (!(error = rio_start_request( request ))) continue;
+        InterlockedIncrement( &rq->refcount );
+        rio_complete_request( request, error, 0 );
+    }
+}
+
+static char *rio_get_buffer( const RIO_BUF *buf )
+{
+    struct rio_buffer *buffer = (struct rio_buffer *)buf->BufferId;
+
+    if (!buffer || buf->BufferId == RIO_INVALID_BUFFERID || buf->Offset > buffer->size ||
+        buf->Length > buffer->size - buf->Offset)
+        return NULL;
+    return buffer->data + buf->Offset;
+}
+
+static BOOL rio_queue_request( RIO_RQ handle, RIO_BUF *buf, ULONG count, RIO_BUF *addr_buf,
+                               DWORD flags, void *context, BOOL send )
+{
+    struct rio_rq *rq = (struct rio_rq *)handle;
+    struct rio_cq *cq = send ? rq->send_cq : rq->recv_cq;
+    struct list *deferred = send ? &rq->deferred_send : &rq->deferred_recv;
+    LONG *num = send ? &rq->num_send : &rq->num_recv;
+    struct rio_request *request;
+    DWORD error;
+    ULONG i;
+    BOOL full;
+
+    if (flags & RIO_MSG_COMMIT_ONLY)
+    {
+        if (count || (flags & RIO_MSG_DEFER))
+        {
+            SetLastError( WSAEINVAL );
+            return FALSE;
+        }
+        rio_commit_deferred( rq, send );
+        return TRUE;
+    }
+
+    if (!count || !buf || count > (send ? rq->max_send_buffers : rq->max_recv_buffers))
+    {
+        SetLastError( WSAEINVAL );
+        return FALSE;
+    }
+
+    if (!(request = rio_alloc_request( rq )))
+    {
+        SetLastError( WSAENOBUFS );
+        return FALSE;
+    }
+    request->context = context;
+    request->send = send;
+    request->flags = flags;
+    request->count = count;
+    request->addr = NULL;
+    request->addr_len = 0;
+    for (i = 0; i < count; i++)
+    {
+        request->buffers[i].len = buf[i].Length;
+        if (!(request->buffers[i].buf = rio_get_buffer( &buf[i] ))) break;
+    }
+    if (i < count || (addr_buf && (!(request->addr = (struct sockaddr *)rio_get_buffer( addr_buf )) ||
+                                   addr_buf->Length < sizeof(SOCKADDR_INET))))
+    {
+        rio_free_request( request );
+        SetLastError( WSAEINVAL );
+        return FALSE;
+    }
+    if (request->addr) request->addr_len = addr_buf->Length;
+
+    if (InterlockedIncrement( num ) > (send ? rq->max_send : rq->max_recv))
+    {
+        InterlockedDecrement( num );
+        rio_free_request( request );
+        SetLastError( WSAENOBUFS );
+        return FALSE;
+    }
+
+    EnterCriticalSection( &cq->cs );
+    if (!(full = (cq->count + cq->pending >= cq->size))) cq->pending++;
+    LeaveCriticalSection( &cq->cs );
+    if (full)
+    {
+        InterlockedDecrement( num );
+        rio_free_request( request );
+        SetLastError( WSAENOBUFS );
+        return FALSE;
+    }
+
+    if ((flags & RIO_MSG_DEFER) || (send ? rq->send_batch : rq->recv_batch))
+    {
+        EnterCriticalSection( &rq->cs );
+        list_add_tail( deferred, &request->entry );
+        LeaveCriticalSection( &rq->cs );
+        if (!(flags & RIO_MSG_DEFER)) rio_commit_deferred( rq, send );
+        return TRUE;
+    }
+
+    rio_commit_deferred( rq, send );
+    if (!(error = rio_start_request( request ))) return TRUE;
+
+    EnterCriticalSection( &cq->cs );
+    cq->pending--;
+    LeaveCriticalSection( &cq->cs );
+    InterlockedDecrement( num );
+    rio_free_request( request );
+    SetLastError( error );
+    return FALSE;
+}
+
+static BOOL WINAPI WS2_RIOReceive( RIO_RQ rq, RIO_BUF *buf, ULONG count, DWORD flags, void *context )
+{
+    TRACE( "rq %p, buf %p, count %lu, flags %#lx, context %p\n", rq, buf, count, flags, context );
+
+    return rio_queue_request( rq, buf, count, NULL, flags, context, FALSE );
+}
+
+static int WINAPI WS2_RIOReceiveEx( RIO_RQ rq, RIO_BUF *buf, ULONG count, RIO_BUF *local_addr,
+                                    RIO_BUF *remote_addr, RIO_BUF *control, RIO_BUF *flags_buf,
+                                    DWORD flags, void *context )
+{
+    TRACE( "rq %p, buf %p, count %lu, local_addr %p, remote_addr %p, control %p, flags_buf %p, "
+           "flags %#lx, context %p\n", rq, buf, count, local_addr, remote_addr, control, flags_buf,
+           flags, context );
+
+    if (local_addr || control || flags_buf)
+        FIXME( "ignoring local address, control and flags buffers\n" );
+
+    return rio_queue_request( rq, buf, count, remote_addr, flags, context, FALSE );
+}
+
+static BOOL WINAPI WS2_RIOSend( RIO_RQ rq, RIO_BUF *buf, ULONG count, DWORD flags, void *context )
+{
+    TRACE( "rq %p, buf %p, count %lu, flags %#lx, context %p\n", rq, buf, count, flags, context );
+
+    return rio_queue_request( rq, buf, count, NULL, flags, context, TRUE );
+}
+
+static BOOL WINAPI WS2_RIOSendEx( RIO_RQ rq, RIO_BUF *buf, ULONG count, RIO_BUF *local_addr,
+                                  RIO_BUF *remote_addr, RIO_BUF *control, RIO_BUF *flags_buf,
+                                  DWORD flags, void *context )
+{
+    TRACE( "rq %p, buf %p, count %lu, local_addr %p, remote_addr %p, control %p, flags_buf %p, "
+           "flags %#lx, context %p\n", rq, buf, count, local_addr, remote_addr, control, flags_buf,
+           flags, context );
+
+    if (local_addr || control || flags_buf)
+        FIXME( "ignoring local address, control and flags buffers\n" );
+
+    return rio_queue_request( rq, buf, count, remote_addr, flags, context, TRUE );
+}
+
+static RIO_CQ WINAPI WS2_RIOCreateCompletionQueue( DWORD size, RIO_NOTIFICATION_COMPLETION *notification )
+{
+    struct rio_cq *cq;
+
+    TRACE( "size %lu, notification %p\n", size, notification );
+
+    if (!size || size > RIO_MAX_CQ_SIZE ||
+        (notification && notification->Type != RIO_EVENT_COMPLETION &&
+         notification->Type != RIO_IOCP_COMPLETION))
+    {
+        SetLastError( WSAEINVAL );
+        return RIO_INVALID_CQ;
+    }
+
+    if (!(cq = calloc( 1, sizeof(*cq) )) || !(cq->results = malloc( size * sizeof(*cq->results) )))
+    {
+        free( cq );
+        SetLastError( WSAENOBUFS );
+        return RIO_INVALID_CQ;
+    }
+    InitializeCriticalSectionEx( &cq->cs, 0, RTL_CRITICAL_SECTION_FLAG_FORCE_DEBUG_INFO );
+    cq->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": rio_cq.cs");
+    cq->size = size;
+    if (notification) cq->notification = *notification;
+    return (RIO_CQ)cq;
+}
+
+static BOOL WINAPI WS2_RIOResizeCompletionQueue( RIO_CQ handle, DWORD size )
+{
+    struct rio_cq *cq = (struct rio_cq *)handle;
+    RIORESULT *results;
+    DWORD i;
+
+    TRACE( "cq %p, size %lu\n", handle, size );
+
+    if (!size || size > RIO_MAX_CQ_SIZE || !(results = malloc( size * sizeof(*results) )))
+    {
+        SetLastError( size && size <= RIO_MAX_CQ_SIZE ? WSAENOBUFS : WSAEINVAL );
+        return FALSE;
+    }
+
+    EnterCriticalSection( &cq->cs );
+    if (cq->count + cq->pending > size)
+    {
+        LeaveCriticalSection( &cq->cs );
+        free( results );
+        SetLastError( WSAEINVAL );
+        return FALSE;
+    }
+    for (i = 0; i < cq->count; i++) results[i] = cq->results[(cq->head + i) % cq->size];
+    free( cq->results );
+    cq->results = results;
+    cq->size = size;
+    cq->head = 0;
+    LeaveCriticalSection( &cq->cs );
+    return TRUE;
+}
+
+static void WINAPI WS2_RIOCloseCompletionQueue( RIO_CQ handle )
+{
+    struct rio_cq *cq = (struct rio_cq *)handle;
+
+    BOOL pending;
+
+    TRACE( "cq %p\n", handle );
+
+    if (!cq) return;
+    EnterCriticalSection( &cq->cs );
+    if ((pending = cq->pending)) cq->closed = TRUE;
+    LeaveCriticalSection( &cq->cs );
+    if (!pending) rio_destroy_cq( cq );
+}
+
+static ULONG WINAPI WS2_RIODequeueCompletion( RIO_CQ handle, RIORESULT *results, ULONG count )
+{
+    struct rio_cq *cq = (struct rio_cq *)handle;
+    ULONG i;
+
+    TRACE( "cq %p, results %p, count %lu\n", handle, results, count );
+
+    if (!cq || !results) return RIO_CORRUPT_CQ;
+
+    EnterCriticalSection( &cq->cs );
+    count = min( count, cq->count );
+    for (i = 0; i < count; i++) results[i] = cq->results[(cq->head + i) % cq->size];
+    cq->head = (cq->head + count) % cq->size;
+    cq->count -= count;
+    LeaveCriticalSection( &cq->cs );
+    return count;
+}
+
+static INT WINAPI WS2_RIONotify( RIO_CQ handle )
+{
+    struct rio_cq *cq = (struct rio_cq *)handle;
+    INT ret = 0;
+
+    TRACE( "cq %p\n", handle );
+
+    EnterCriticalSection( &cq->cs );
+    if (!cq->notification.Type) ret = WSAEINVAL;
+    else if (cq->notify) ret = WSAEALREADY;
+    else
+    {
+        if (cq->notification.Type == RIO_EVENT_COMPLETION && cq->notification.Event.NotifyReset)
+            ResetEvent( cq->notification.Event.EventHandle );
+        if (cq->count) rio_cq_notify( cq );
+        else cq->notify = TRUE;
+    }
+    LeaveCriticalSection( &cq->cs );
+    return ret;
+}
+
+static RIO_RQ WINAPI WS2_RIOCreateRequestQueue( SOCKET s, ULONG max_recv, ULONG max_recv_buffers,
+                                                ULONG max_send, ULONG max_send_buffers,
+                                                RIO_CQ recv_cq, RIO_CQ send_cq, void *context )
+{
+    struct rio_rq *rq;
+    int type, len = sizeof(type);
+
+    TRACE( "socket %#Ix, max_recv %lu, max_recv_buffers %lu, max_send %lu, max_send_buffers %lu, "
+           "recv_cq %p, send_cq %p, context %p\n", s, max_recv, max_recv_buffers, max_send,
+           max_send_buffers, recv_cq, send_cq, context );
+
+    if (!is_valid_socket( s ))
+    {
+        SetLastError( WSAENOTSOCK );
+        return RIO_INVALID_RQ;
+    }
+    if (!recv_cq || !send_cq || max_recv_buffers > RIO_MAX_DATA_BUFFERS || max_send_buffers > RIO_MAX_DATA_BUFFERS)
+    {
+        SetLastError( WSAEINVAL );
+        return RIO_INVALID_RQ;
+    }
+
+    if (!(rq = calloc( 1, sizeof(*rq) )))
+    {
+        SetLastError( WSAENOBUFS );
+        return RIO_INVALID_RQ;
+    }
+    rq->refcount = 1;
+    InitializeCriticalSectionEx( &rq->cs, 0, RTL_CRITICAL_SECTION_FLAG_FORCE_DEBUG_INFO );
+    rq->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": rio_rq.cs");
+    rq->socket = s;
+    rq->context = context;
+    rq->recv_cq = (struct rio_cq *)recv_cq;
+    rq->send_cq = (struct rio_cq *)send_cq;
+    rq->max_recv = max_recv;
+    rq->max_send = max_send;
+    rq->max_recv_buffers = max_recv_buffers;
+    rq->max_send_buffers = max_send_buffers;
+    list_init( &rq->deferred_recv );
+    list_init( &rq->deferred_send );
+    list_init( &rq->free );
+
+    if (!getsockopt( s, SOL_SOCKET, SO_TYPE, (char *)&type, &len ) && type == SOCK_DGRAM &&
+        (!(rq->recv_batch = rio_create_batch( rq, max_recv_buffers, FALSE )) ||
+         !(rq->send_batch = rio_create_batch( rq, max_send_buffers, TRUE ))))
+    {
+        rio_rq_release( rq );
+        SetLastError( WSAENOBUFS );
+        return RIO_INVALID_RQ;
+    }
+
+    EnterCriticalSection( &cs_rio_rq_list );
+    list_add_tail( &rio_rq_list, &rq->entry );
+    LeaveCriticalSection( &cs_rio_rq_list );
+    return (RIO_RQ)rq;
+}
+
+static BOOL WINAPI WS2_RIOResizeRequestQueue( RIO_RQ handle, DWORD max_recv, DWORD max_send )
+{
+    struct rio_rq *rq = (struct rio_rq *)handle;
+
+    TRACE( "rq %p, max_recv %lu, max_send %lu\n", handle, max_recv, max_send );
+
+    if (max_recv < rq->num_recv || max_send < rq->num_send)
+    {
+        SetLastError( WSAEINVAL );
+        return FALSE;
+    }
+    rq->max_recv = max_recv;
+    rq->max_send = max_send;
+    return TRUE;
+}
+
+static RIO_BUFFERID WINAPI WS2_RIORegisterBuffer( char *data, DWORD size )
+{
+    struct rio_buffer *buffer;
+
+    TRACE( "data %p, size %lu\n", data, size );
+
+    if (!(buffer = malloc( sizeof(*buffer) )))
+    {
+        SetLastError( WSAENOBUFS );
+        return RIO_INVALID_BUFFERID;
+    }
+    buffer->data = data;
+    buffer->size = size;
+    return (RIO_BUFFERID)buffer;
+}
+
+static void WINAPI WS2_RIODeregisterBuffer( RIO_BUFFERID id )
+{
+    TRACE( "id %p\n", id );
+
+    if (id != RIO_INVALID_BUFFERID) free( id );
+}
+
+static const RIO_EXTENSION_FUNCTION_TABLE rio_function_table =
+{
+    sizeof(RIO_EXTENSION_FUNCTION_TABLE),
+    WS2_RIOReceive,
+    WS2_RIOReceiveEx,
+    WS2_RIOSend,
+    WS2_RIOSendEx,
+    WS2_RIOCloseCompletionQueue,
+    WS2_RIOCreateCompletionQueue,
+    WS2_RIOCreateRequestQueue,
+    WS2_RIODequeueCompletion,
+    WS2_RIODeregisterBuffer,
+    WS2_RIONotify,
+    WS2_RIORegisterBuffer,
+    WS2_RIOResizeCompletionQueue,
+    WS2_RIOResizeRequestQueue,
+};
+
+
 /***********************************************************************
  *     WSASendMsg
  */
@@ -1359,6 +2173,7 @@ int WINAPI closesocket( SOCKET s )
         return -1;
     }
 
+    rio_close_socket( s );
     CloseHandle( (HANDLE)s );
     return 0;
 }
@@ -2696,6 +3511,35 @@ INT WINAPI WSAIoctl(SOCKET s, DWORD code, LPVOID in_buff, DWORD in_size, LPVOID
         return -1;
     }
 
+    case SIO_GET_MULTIPLE_EXTENSION_FUNCTION_POINTER:
+    {
+        static const GUID rio_guid = WSAID_MULTIPLE_RIO;
+        NTSTATUS status = STATUS_SUCCESS;
+        DWORD ret;
+
+        if (!in_buff || in_size < sizeof(GUID) || !IsEqualGUID( &rio_guid, in_buff ))
+        {
+            FIXME( "SIO_GET_MULTIPLE_EXTENSION_FUNCTION_POINTER %s: stub\n",
+                   in_buff && in_size >= sizeof(GUID) ? debugstr_guid(in_buff) : "(null)" );
+            SetLastError( WSAEINVAL );
+            return -1;
+        }
+        if (!out_buff || out_size < sizeof(rio_function_table))
+        {
+            SetLastError( WSAEFAULT );
+            return -1;
+        }
+
+        TRACE( "returning RIO function table\n" );
+        memcpy( out_buff, &rio_function_table, sizeof(rio_function_table) );
+
+        ret = server_ioctl_sock( s, IOCTL_AFD_WINE_COMPLETE_ASYNC, &status, sizeof(status),
+                                 NULL, 0, ret_size, overlapped, completion );
+        *ret_size = sizeof(rio_function_table);
+        SetLastError( ret );
+        return ret ? -1 : 0;
+    }
+
     case SIO_KEEPALIVE_VALS:
     {
         DWORD ret;
@@ -15043,6 +15043,219 @@ static void test_afunix(void)
     test_afunix_path( path );
 }
 
+static void test_registered_io(void)
+{
+    GUID rio_guid = WSAID_MULTIPLE_RIO;
+    RIO_NOTIFICATION_COMPLETION notification;
+    RIO_EXTENSION_FUNCTION_TABLE rio;
+    struct sockaddr_in addr;
+    RIORESULT result, results[4];
+    OVERLAPPED *overlapped;
+    unsigned int i, count;
+    SOCKET src, dst;
+    HANDLE event, port;
+    char buffer[64];
+    RIO_BUFFERID id;
+    ULONG_PTR key;
+    RIO_BUF buf, bufs[3];
+    DWORD size;
+    RIO_CQ cq;
+    RIO_RQ rq;
+    int ret, len;
+
+    dst = WSASocketA(AF_INET, SOCK_DGRAM, IPPROTO_UDP, NULL, 0, WSA_FLAG_OVERLAPPED | WSA_FLAG_REGISTERED_IO);
+    ok(dst != INVALID_SOCKET, "failed to create socket, error %u\n", WSAGetLastError());
+
+    memset(&rio, 0, sizeof(rio));
+    ret = WSAIoctl(dst, SIO_GET_MULTIPLE_EXTENSION_FUNCTION_POINTER, &rio_guid, sizeof(rio_guid),
+                   &rio, sizeof(rio), &size, NULL, NULL);
+    if (ret)
+    {
+        win_skip("Registered I/O is not supported.\n");
+        closesocket(dst);
+        return;
+    }
+    ok(size == sizeof(rio), "got size %lu\n", size);
+    ok(rio.cbSize == sizeof(rio), "got cbSize %lu\n", rio.cbSize);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ret = bind(dst, (struct sockaddr *)&addr, sizeof(addr));
+    ok(!ret, "failed to bind socket, error %u\n", WSAGetLastError());
+    len = sizeof(addr);
+    ret = getsockname(dst, (struct sockaddr *)&addr, &len);
+    ok(!ret, "failed to get address, error %u\n", WSAGetLastError());
+
+    event = CreateEventW(NULL, FALSE, FALSE, NULL);
+    notification.Type = RIO_EVENT_COMPLETION;
+    notification.Event.EventHandle = event;
+    notification.Event.NotifyReset = FALSE;
+    cq = rio.RIOCreateCompletionQueue(8, &notification);
+    ok(cq != RIO_INVALID_CQ, "failed to create completion queue, error %u\n", WSAGetLastError());
+
+    rq = rio.RIOCreateRequestQueue(dst, 4, 1, 4, 1, cq, cq, (void *)0xdead);
+    ok(rq != RIO_INVALID_RQ, "failed to create request queue, error %u\n", WSAGetLastError());
+
+    id = rio.RIORegisterBuffer(buffer, sizeof(buffer));
+    ok(id != RIO_INVALID_BUFFERID, "failed to register buffer, error %u\n", WSAGetLastError());
+
+    ret = rio.RIODequeueCompletion(cq, &result, 1);
+    ok(!ret, "got %d\n", ret);
+
+    buf.BufferId = id;
+    buf.Offset = 0;
+    buf.Length = sizeof(buffer);
+    ret = rio.RIOReceive(rq, &buf, 1, 0, (void *)0xbeef);
+    ok(ret, "RIOReceive failed, error %u\n", WSAGetLastError());
+
+    ret = rio.RIONotify(cq);
+    ok(!ret, "got error %d\n", ret);
+    ret = rio.RIONotify(cq);
+    ok(ret == WSAEALREADY, "got error %d\n", ret);
+
+    src = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    ok(src != INVALID_SOCKET, "failed to create socket, error %u\n", WSAGetLastError());
+    ret = sendto(src, "hello", 5, 0, (struct sockaddr *)&addr, sizeof(addr));
+    ok(ret == 5, "got %d, error %u\n", ret, WSAGetLastError());
+
+    ret = WaitForSingleObject(event, 1000);
+    ok(!ret, "wait returned %#x\n", ret);
+
+    memset(&result, 0xcc, sizeof(result));
+    ret = rio.RIODequeueCompletion(cq, &result, 1);
+    ok(ret == 1, "got %d\n", ret);
+    ok(!result.Status, "got status %ld\n", result.Status);
+    ok(result.BytesTransferred == 5, "got size %lu\n", result.BytesTransferred);
+    ok(result.SocketContext == 0xdead, "got socket context %#I64x\n", result.SocketContext);
+    ok(result.RequestContext == 0xbeef, "got request context %#I64x\n", result.RequestContext);
+    ok(!memcmp(buffer, "hello", 5), "got %s\n", debugstr_an(buffer, 5));
+
+    ret = rio.RIOReceive(rq, &buf, 1, RIO_MSG_DEFER, (void *)0xcafe);
+    ok(ret, "RIOReceive failed, error %u\n", WSAGetLastError());
+    ret = rio.RIOReceive(rq, &buf, 1, RIO_MSG_COMMIT_ONLY | RIO_MSG_DEFER, NULL);
+    ok(!ret, "RIOReceive succeeded\n");
+    ok(WSAGetLastError() == WSAEINVAL, "got error %u\n", WSAGetLastError());
+    ret = rio.RIOReceive(rq, NULL, 0, RIO_MSG_COMMIT_ONLY, NULL);
+    ok(ret, "RIOReceive failed, error %u\n", WSAGetLastError());
+
+    ret = rio.RIONotify(cq);
+    ok(!ret, "got error %d\n", ret);
+    ret = sendto(src, "world", 5, 0, (struct sockaddr *)&addr, sizeof(addr));
+    ok(ret == 5, "got %d, error %u\n", ret, WSAGetLastError());
+    ret = WaitForSingleObject(event, 1000);
+    ok(!ret, "wait returned %#x\n", ret);
+
+    memset(&result, 0xcc, sizeof(result));
+    ret = rio.RIODequeueCompletion(cq, &result, 1);
+    ok(ret == 1, "got %d\n", ret);
+    ok(!result.Status, "got status %ld\n", result.Status);
+    ok(result.BytesTransferred == 5, "got size %lu\n", result.BytesTransferred);
+    ok(result.RequestContext == 0xcafe, "got request context %#I64x\n", result.RequestContext);
+    ok(!memcmp(buffer, "world", 5), "got %s\n", debugstr_an(buffer, 5));
+
+    closesocket(src);
+    closesocket(dst);
+
+    /* completions of registered I/O are not posted to the socket completion port */
+    dst = WSASocketA(AF_INET, SOCK_DGRAM, IPPROTO_UDP, NULL, 0, WSA_FLAG_OVERLAPPED | WSA_FLAG_REGISTERED_IO);
+    ok(dst != INVALID_SOCKET, "failed to create socket, error %u\n", WSAGetLastError());
+    addr.sin_port = 0;
+    ret = bind(dst, (struct sockaddr *)&addr, sizeof(addr));
+    ok(!ret, "failed to bind socket, error %u\n", WSAGetLastError());
+    len = sizeof(addr);
+    ret = getsockname(dst, (struct sockaddr *)&addr, &len);
+    ok(!ret, "failed to get address, error %u\n", WSAGetLastError());
+    port = CreateIoCompletionPort((HANDLE)dst, NULL, 0x1234, 0);
+    ok(!!port, "failed to create completion port, error %lu\n", GetLastError());
+
+    rq = rio.RIOCreateRequestQueue(dst, 4, 1, 4, 1, cq, cq, (void *)0xdead);
+    ok(rq != RIO_INVALID_RQ, "failed to create request queue, error %u\n", WSAGetLastError());
+    ret = rio.RIOReceive(rq, &buf, 1, 0, (void *)0xbeef);
+    ok(ret, "RIOReceive failed, error %u\n", WSAGetLastError());
+    ret = rio.RIONotify(cq);
+    ok(!ret, "got error %d\n", ret);
+
+    src = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    ok(src != INVALID_SOCKET, "failed to create socket, error %u\n", WSAGetLastError());
+    ret = sendto(src, "hello", 5, 0, (struct sockaddr *)&addr, sizeof(addr));
+    ok(ret == 5, "got %d, error %u\n", ret, WSAGetLastError());
+    ret = WaitForSingleObject(event, 1000);
+    ok(!ret, "wait returned %#x\n", ret);
+
+    ret = rio.RIODequeueCompletion(cq, &result, 1);
+    ok(ret == 1, "got %d\n", ret);
+    ok(result.BytesTransferred == 5, "got size %lu\n", result.BytesTransferred);
+    ret = GetQueuedCompletionStatus(port, &size, &key, &overlapped, 0);
+    ok(!ret, "got completion\n");
+    ok(GetLastError() == WAIT_TIMEOUT, "got error %lu\n", GetLastError());
+
+    /* several datagrams received by requests committed together complete in order */
+    memset(buffer, 0, sizeof(buffer));
+    for (i = 0; i < 3; ++i)
+    {
+        bufs[i].BufferId = id;
+        bufs[i].Offset = i * 16;
+        bufs[i].Length = 16;
+        ret = rio.RIOReceive(rq, &bufs[i], 1, RIO_MSG_DEFER, (void *)(ULONG_PTR)(0x100 + i));
+        ok(ret, "RIOReceive failed, error %u\n", WSAGetLastError());
+    }
+    ret = rio.RIOReceive(rq, NULL, 0, RIO_MSG_COMMIT_ONLY, NULL);
+    ok(ret, "RIOReceive failed, error %u\n", WSAGetLastError());
+    for (i = 0; i < 3; ++i)
+    {
+        ret = sendto(src, "data0", 5, 0, (struct sockaddr *)&addr, sizeof(addr));
+        ok(ret == 5, "got %d, error %u\n", ret, WSAGetLastError());
+    }
+
+    count = 0;
+    while (count < 3)
+    {
+        ret = rio.RIONotify(cq);
+        ok(!ret, "got error %d\n", ret);
+        ret = WaitForSingleObject(event, 1000);
+        ok(!ret, "wait returned %#x\n", ret);
+        if (ret) break;
+        ret = rio.RIODequeueCompletion(cq, results + count, ARRAY_SIZE(results) - count);
+        ok(ret > 0 && ret <= 3 - count, "got %d\n", ret);
+        count += ret;
+    }
+    ok(count == 3, "got %u completions\n", count);
+    for (i = 0; i < count; ++i)
+    {
+        winetest_push_context("%u", i);
+        ok(!results[i].Status, "got status %ld\n", results[i].Status);
+        ok(results[i].BytesTransferred == 5, "got size %lu\n", results[i].BytesTransferred);
+        ok(results[i].RequestContext == 0x100 + i, "got request context %#I64x\n", results[i].RequestContext);
+        ok(!memcmp(buffer + i * 16, "data0", 5), "got %s\n", debugstr_an(buffer + i * 16, 5));
+        winetest_pop_context();
+    }
+
+    closesocket(src);
+    closesocket(dst);
+    CloseHandle(port);
+    rio.RIOCloseCompletionQueue(cq);
+
+    /* a completion queue may be closed while requests are still pending on it */
+    dst = WSASocketA(AF_INET, SOCK_DGRAM, IPPROTO_UDP, NULL, 0, WSA_FLAG_OVERLAPPED | WSA_FLAG_REGISTERED_IO);
+    ok(dst != INVALID_SOCKET, "failed to create socket, error %u\n", WSAGetLastError());
+    addr.sin_port = 0;
+    ret = bind(dst, (struct sockaddr *)&addr, sizeof(addr));
+    ok(!ret, "failed to bind socket, error %u\n", WSAGetLastError());
+    cq = rio.RIOCreateCompletionQueue(8, NULL);
+    ok(cq != RIO_INVALID_CQ, "failed to create completion queue, error %u\n", WSAGetLastError());
+    rq = rio.RIOCreateRequestQueue(dst, 4, 1, 4, 1, cq, cq, NULL);
+    ok(rq != RIO_INVALID_RQ, "failed to create request queue, error %u\n", WSAGetLastError());
+    ret = rio.RIOReceive(rq, &buf, 1, 0, NULL);
+    ok(ret, "RIOReceive failed, error %u\n", WSAGetLastError());
+    rio.RIOCloseCompletionQueue(cq);
+    closesocket(dst);
+    Sleep(100);
+
+    rio.RIODeregisterBuffer(id);
+    CloseHandle(event);
+}
+
 START_TEST( sock )
 {
     int i;
@@ -15131,6 +15344,7 @@ START_TEST( sock )
     test_send_buffering();
     test_valid_handle();
     test_afunix();
+    test_registered_io();
 
     /* There is apparently an obscure interaction between this test and
      * test_WSAGetOverlappedResult().
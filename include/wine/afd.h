@@ -291,6 +291,8 @@ C_ASSERT( sizeof(struct afd_get_events_params) == 56 );
 #define IOCTL_AFD_WINE_SET_TCP_KEEPCNT                  WINE_AFD_IOC(302)
 #define IOCTL_AFD_WINE_GET_TCP_KEEPINTVL                WINE_AFD_IOC(303)
 #define IOCTL_AFD_WINE_SET_TCP_KEEPINTVL                WINE_AFD_IOC(304)
+#define IOCTL_AFD_WINE_RECVMMSG                         WINE_AFD_IOC(305)
+#define IOCTL_AFD_WINE_SENDMMSG                         WINE_AFD_IOC(306)
 
 struct afd_iovec
 {
@@ -344,6 +346,20 @@ struct afd_sendmsg_params
 };
 C_ASSERT( sizeof(struct afd_sendmsg_params) == 32 );
 
+/* maximum number of messages in a single IOCTL_AFD_WINE_RECVMMSG or IOCTL_AFD_WINE_SENDMMSG */
+#define AFD_MAX_MMSG_COUNT 1024
+
+struct afd_mmsg_params
+{
+    ULONGLONG addr_ptr; /* WS(sockaddr) */
+    ULONGLONG iov_ptr; /* struct afd_iovec[] */
+    unsigned int iov_count;
+    int addr_len; /* for receives, updated with the size of the source address */
+    unsigned int status; /* set for each message that was transferred */
+    unsigned int size; /* number of bytes transferred */
+};
+C_ASSERT( sizeof(struct afd_mmsg_params) == 32 );
+
 struct afd_transmit_params
 {
     LARGE_INTEGER offset;
@@ -857,7 +857,8 @@ struct pe_image_info
     unsigned char  wine_builtin : 1;
     unsigned char  wine_fakedll : 1;
     unsigned char  is_hybrid : 1;
-    unsigned char  padding : 4;
+    unsigned char  has_relocated : 1;
+    unsigned char  padding : 3;
     unsigned char  image_flags;
     unsigned int   loader_flags;
     unsigned int   header_size;
@@ -2276,6 +2277,8 @@ struct get_image_map_address_reply
 {
     struct reply_header __header;
     client_ptr_t addr;
+    obj_handle_t relocated_file;
+    char __pad_20[4];
 };
 
 
@@ -5579,6 +5582,15 @@ struct add_completion_reply
 };
 
 
+struct completion_info
+{
+    apc_param_t   ckey;
+    apc_param_t   cvalue;
+    apc_param_t   information;
+    unsigned int  status;
+    int           __pad;
+};
+
 
 struct remove_completion_request
 {
@@ -5595,6 +5607,7 @@ struct remove_completion_reply
     apc_param_t   information;
     unsigned int  status;
     obj_handle_t  wait_handle;
+    /* VARARG(more,completion_infos); */
 };
 
 
@@ -7183,6 +7196,6 @@ union generic_reply
     struct alpc_create_port_reply alpc_create_port_reply;
 };
 
-#define SERVER_PROTOCOL_VERSION 961
+#define SERVER_PROTOCOL_VERSION 963
 
 #endif /* __WINE_WINE_SERVER_PROTOCOL_H */
@@ -367,6 +367,30 @@ DECL_HANDLER(remove_completion)
         reply->information = msg->information;
         free( msg );
         reply->wait_handle = 0;
+
+        /* return as many further completions as the client has room for */
+        if (get_reply_max_size() >= sizeof(struct completion_info))
+        {
+            struct completion_info *info;
+            data_size_t count = min( completion->depth, get_reply_max_size() / sizeof(*info) );
+
+            if (count && (info = set_reply_data_size( count * sizeof(*info) )))
+            {
+                for ( ; count; count--, info++)
+                {
+                    entry = list_head( &completion->queue );
+                    list_remove( entry );
+                    completion->depth--;
+                    msg = LIST_ENTRY( entry, struct comp_msg, queue_entry );
+                    info->ckey        = msg->ckey;
+                    info->cvalue      = msg->cvalue;
+                    info->information = msg->information;
+                    info->status      = msg->status;
+                    info->__pad       = 0;
+                    free( msg );
+                }
+            }
+        }
         if (list_empty( &completion->queue )) reset_sync( completion->sync );
     }
 
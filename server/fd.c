@@ -274,14 +274,25 @@ static file_pos_t max_unix_offset = OFF_T_MAX;
 
 struct timeout_user
 {
-    struct list           entry;      /* entry in sorted timeout list */
+    struct list           entry;      /* entry in expired list */
+    int                   index;      /* index in timeout heap, -1 once expired */
+    unsigned int          seq;        /* insertion sequence number */
     abstime_t             when;       /* timeout expiry */
     timeout_callback      callback;   /* callback function */
     void                 *private;    /* callback private data */
 };
 
-static struct list abs_timeout_list = LIST_INIT(abs_timeout_list); /* sorted absolute timeouts list */
-static struct list rel_timeout_list = LIST_INIT(rel_timeout_list); /* sorted relative timeouts list */
+/* binary min-heap of timeouts ordered by expiry time */
+struct timeout_heap
+{
+    struct timeout_user **entries;    /* heap array */
+    int                   count;      /* number of entries in use */
+    int                   size;       /* allocated size of the array */
+};
+
+static struct timeout_heap abs_timeout_heap;  /* absolute timeouts heap */
+static struct timeout_heap rel_timeout_heap;  /* relative timeouts heap */
+static unsigned int timeout_seq;              /* sequence number for the next timeout */
 timeout_t current_time;
 timeout_t monotonic_time;
 
@@ -371,43 +382,113 @@ void set_current_time(void)
     if (user_shared_data) set_user_shared_data_time();
 }
 
+/* check whether timeout a expires before timeout b; both must be in the same heap */
+static inline int timeout_before( const struct timeout_user *a, const struct timeout_user *b )
+{
+    /* relative timeouts are stored as negated monotonic times */
+    if (a->when != b->when) return a->when > 0 ? a->when < b->when : a->when > b->when;
+    /* on equal expiry, the most recently added timeout goes first */
+    return (int)(a->seq - b->seq) > 0;
+}
+
+static inline void timeout_heap_set( struct timeout_heap *heap, int index, struct timeout_user *user )
+{
+    heap->entries[index] = user;
+    user->index = index;
+}
+
+static void timeout_heap_sift_up( struct timeout_heap *heap, int index )
+{
+    struct timeout_user *user = heap->entries[index];
+
+    while (index)
+    {
+        int parent = (index - 1) / 2;
+        if (!timeout_before( user, heap->entries[parent] )) break;
+        timeout_heap_set( heap, index, heap->entries[parent] );
+        index = parent;
+    }
+    timeout_heap_set( heap, index, user );
+}
+
+static void timeout_heap_sift_down( struct timeout_heap *heap, int index )
+{
+    struct timeout_user *user = heap->entries[index];
+
+    for (;;)
+    {
+        int child = 2 * index + 1;
+        if (child >= heap->count) break;
+        if (child + 1 < heap->count && timeout_before( heap->entries[child + 1], heap->entries[child] ))
+            child++;
+        if (!timeout_before( heap->entries[child], user )) break;
+        timeout_heap_set( heap, index, heap->entries[child] );
+        index = child;
+    }
+    timeout_heap_set( heap, index, user );
+}
+
+static int timeout_heap_insert( struct timeout_heap *heap, struct timeout_user *user )
+{
+    if (heap->count == heap->size)
+    {
+        struct timeout_user **new_entries;
+        int size = max( heap->size * 2, 64 );
+
+        if (!(new_entries = realloc( heap->entries, size * sizeof(*new_entries) )))
+        {
+            set_error( STATUS_NO_MEMORY );
+            return 0;
+        }
+        heap->entries = new_entries;
+        heap->size    = size;
+    }
+    timeout_heap_set( heap, heap->count++, user );
+    timeout_heap_sift_up( heap, user->index );
+    return 1;
+}
+
+static void timeout_heap_remove( struct timeout_heap *heap, struct timeout_user *user )
+{
+    struct timeout_user *last = heap->entries[--heap->count];
+    int index = user->index;
+
+    user->index = -1;
+    if (last == user) return;
+    timeout_heap_set( heap, index, last );
+    timeout_heap_sift_up( heap, index );
+    if (last->index == index) timeout_heap_sift_down( heap, index );
+}
+
+static inline struct timeout_heap *get_timeout_heap( const struct timeout_user *user )
+{
+    return user->when > 0 ? &abs_timeout_heap : &rel_timeout_heap;
+}
+
 /* add a timeout user */
 struct timeout_user *add_timeout_user( timeout_t when, timeout_callback func, void *private )
 {
     struct timeout_user *user;
-    struct list *ptr;
 
     if (!(user = mem_alloc( sizeof(*user) ))) return NULL;
     user->when     = timeout_to_abstime( when );
+    user->seq      = timeout_seq++;
     user->callback = func;
     user->private  = private;
 
-    /* Now insert it in the linked list */
-
-    if (user->when > 0)
+    if (!timeout_heap_insert( get_timeout_heap( user ), user ))
     {
-        LIST_FOR_EACH( ptr, &abs_timeout_list )
-        {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
-            if (timeout->when >= user->when) break;
-        }
-    }
-    else
-    {
-        LIST_FOR_EACH( ptr, &rel_timeout_list )
-        {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
-            if (timeout->when <= user->when) break;
-        }
+        free( user );
+        return NULL;
     }
-    list_add_before( ptr, &user->entry );
     return user;
 }
 
 /* remove a timeout user */
 void remove_timeout_user( struct timeout_user *user )
 {
-    list_remove( &user->entry );
+    if (user->index == -1) list_remove( &user->entry );  /* already expired */
+    else timeout_heap_remove( get_timeout_heap( user ), user );
     free( user );
 }
 
@@ -844,58 +925,45 @@ static int get_next_timeout( struct timespec *ts )
 {
     timeout_t ret = user_shared_data ? user_shared_data_timeout : -1;
 
-    if (!list_empty( &abs_timeout_list ) || !list_empty( &rel_timeout_list ))
+    if (abs_timeout_heap.count || rel_timeout_heap.count)
     {
+        struct timeout_user *timeout;
         struct list expired_list, *ptr;
 
-        /* first remove all expired timers from the list */
+        /* first remove all expired timers from the heaps */
 
         list_init( &expired_list );
-        while ((ptr = list_head( &abs_timeout_list )) != NULL)
+        while (abs_timeout_heap.count && (timeout = abs_timeout_heap.entries[0])->when <= current_time)
         {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
-
-            if (timeout->when <= current_time)
-            {
-                list_remove( &timeout->entry );
-                list_add_tail( &expired_list, &timeout->entry );
-            }
-            else break;
+            timeout_heap_remove( &abs_timeout_heap, timeout );
+            list_add_tail( &expired_list, &timeout->entry );
         }
-        while ((ptr = list_head( &rel_timeout_list )) != NULL)
+        while (rel_timeout_heap.count && -(timeout = rel_timeout_heap.entries[0])->when <= monotonic_time)
         {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
-
-            if (-timeout->when <= monotonic_time)
-            {
-                list_remove( &timeout->entry );
-                list_add_tail( &expired_list, &timeout->entry );
-            }
-            else break;
+            timeout_heap_remove( &rel_timeout_heap, timeout );
+            list_add_tail( &expired_list, &timeout->entry );
         }
 
         /* now call the callback for all the removed timers */
 
         while ((ptr = list_head( &expired_list )) != NULL)
         {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
+            timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
             list_remove( &timeout->entry );
             timeout->callback( timeout->private );
             free( timeout );
         }
 
-        if ((ptr = list_head( &abs_timeout_list )) != NULL)
+        if (abs_timeout_heap.count)
         {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
-            timeout_t diff = timeout->when - current_time;
+            timeout_t diff = abs_timeout_heap.entries[0]->when - current_time;
             if (diff < 0) diff = 0;
             if (ret == -1 || diff < ret) ret = diff;
         }
 
-        if ((ptr = list_head( &rel_timeout_list )) != NULL)
+        if (rel_timeout_heap.count)
         {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
-            timeout_t diff = -timeout->when - monotonic_time;
+            timeout_t diff = -rel_timeout_heap.entries[0]->when - monotonic_time;
             if (diff < 0) diff = 0;
             if (ret == -1 || diff < ret) ret = diff;
         }
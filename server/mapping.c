@@ -69,12 +69,15 @@ static const struct object_ops ranges_ops =
     .destroy = ranges_destroy,
 };
 
-/* file backing the shared sections of a PE image mapping */
+/* file backing the shared sections or the relocated contents of a PE image mapping */
 struct shared_map
 {
     struct object   obj;             /* object header */
     struct fd      *fd;              /* file descriptor of the mapped PE file */
     struct file    *file;            /* temp file holding the shared data */
+    client_ptr_t    base;            /* base address of a relocated image, 0 for shared sections */
+    off_t           file_size;       /* size of the PE file the relocated image was built from */
+    struct timespec file_mtime;      /* modification time of the PE file the relocated image was built from */
     struct list     entry;           /* entry in global shared maps list */
 };
 
@@ -98,6 +101,7 @@ struct memory_view
     struct fd      *fd;              /* fd for mapped file */
     struct ranges  *committed;       /* list of committed ranges in this mapping */
     struct shared_map *shared;       /* temp file for shared PE mapping */
+    struct shared_map *relocated;    /* temp file for relocated PE mapping */
     struct pe_image_info image;      /* image info (for PE image mapping) */
     unsigned int    flags;           /* SEC_* flags */
     client_ptr_t    base;            /* view base address (in process addr space) */
@@ -131,6 +135,7 @@ struct mapping
     struct pe_image_info image;      /* image info (for PE image mapping) */
     struct ranges       *committed;  /* list of committed ranges in this mapping */
     struct shared_map   *shared;     /* temp file for shared PE mapping */
+    struct shared_map   *relocated;  /* temp file for relocated PE mapping */
     char                *exp_name;   /* export name (for PE image mapping) */
     void                *ver_res;    /* version resource (for PE image mapping) */
     data_size_t          exp_len;    /* length of export name (for PE image mapping) */
@@ -181,6 +186,7 @@ struct addr_range
 static size_t host_page_mask;
 static const size_t page_mask = 0xfff;
 static const size_t granularity_mask = 0xffff;
+static const mem_size_t max_relocated_image_size = 512 * 1024;  /* larger images are relocated by the client */
 static struct addr_range ranges32;
 static struct addr_range ranges64;
 
@@ -243,7 +249,8 @@ static void ranges_destroy( struct object *obj )
 static void shared_map_dump( struct object *obj, int verbose )
 {
     struct shared_map *shared = (struct shared_map *)obj;
-    fprintf( stderr, "Shared mapping fd=%p file=%p\n", shared->fd, shared->file );
+    fprintf( stderr, "Shared mapping fd=%p file=%p base=%08x%08x\n", shared->fd, shared->file,
+             (unsigned int)(shared->base >> 32), (unsigned int)shared->base );
 }
 
 static void shared_map_destroy( struct object *obj )
@@ -446,6 +453,7 @@ static void free_memory_view( struct memory_view *view )
     if (view->fd) release_object( view->fd );
     if (view->committed) release_object( view->committed );
     if (view->shared) release_object( view->shared );
+    if (view->relocated) release_object( view->relocated );
     list_remove( &view->entry );
     free( view );
 }
@@ -459,13 +467,13 @@ void free_mapped_views( struct process *process )
         free_memory_view( LIST_ENTRY( ptr, struct memory_view, entry ));
 }
 
-/* find the shared PE mapping for a given mapping */
-static struct shared_map *get_shared_file( struct fd *fd )
+/* find the shared PE mapping for a given mapping and base address */
+static struct shared_map *get_shared_file( struct fd *fd, client_ptr_t base )
 {
     struct shared_map *ptr;
 
     LIST_FOR_EACH_ENTRY( ptr, &shared_map_list, struct shared_map, entry )
-        if (is_same_file_fd( ptr->fd, fd ))
+        if (ptr->base == base && is_same_file_fd( ptr->fd, fd ))
             return (struct shared_map *)grab_object( ptr );
     return NULL;
 }
@@ -605,7 +613,7 @@ static int build_shared_mapping( struct mapping *mapping, size_t align_mask, int
     }
     if (!total_size) return 1;  /* nothing to do */
 
-    if ((mapping->shared = get_shared_file( mapping->fd ))) return 1;
+    if ((mapping->shared = get_shared_file( mapping->fd, 0 ))) return 1;
 
     /* create a temp file for the mapping */
 
@@ -644,6 +652,9 @@ static int build_shared_mapping( struct mapping *mapping, size_t align_mask, int
     if (!(shared = alloc_object( &shared_map_ops ))) goto error;
     shared->fd = (struct fd *)grab_object( mapping->fd );
     shared->file = file;
+    shared->base = 0;
+    shared->file_size = 0;
+    shared->file_mtime.tv_sec = shared->file_mtime.tv_nsec = 0;
     list_add_head( &shared_map_list, &shared->entry );
     mapping->shared = shared;
     free( buffer );
@@ -655,6 +666,201 @@ static int build_shared_mapping( struct mapping *mapping, size_t align_mask, int
     return 0;
 }
 
+/* apply a block of base relocations to a relocated image */
+static int apply_relocation_block( char *base, mem_size_t size, const IMAGE_BASE_RELOCATION *rel,
+                                   mem_size_t delta )
+{
+    const unsigned short *reloc = (const unsigned short *)(rel + 1);
+    unsigned int count = (rel->SizeOfBlock - sizeof(*rel)) / sizeof(*reloc);
+    char *page = base + rel->VirtualAddress;
+    mem_size_t limit = size - rel->VirtualAddress;
+
+    for ( ; count; count--, reloc++)
+    {
+        unsigned int offset = *reloc & 0xfff;
+
+        switch (*reloc >> 12)
+        {
+        case IMAGE_REL_BASED_ABSOLUTE:
+            break;
+        case IMAGE_REL_BASED_HIGH:
+            if (offset + sizeof(short) > limit) return 0;
+            *(short *)(page + offset) += (short)(delta >> 16);
+            break;
+        case IMAGE_REL_BASED_LOW:
+            if (offset + sizeof(short) > limit) return 0;
+            *(short *)(page + offset) += (short)delta;
+            break;
+        case IMAGE_REL_BASED_HIGHLOW:
+            if (offset + sizeof(int) > limit) return 0;
+            *(int *)(page + offset) += (int)delta;
+            break;
+        case IMAGE_REL_BASED_DIR64:
+            if (offset + sizeof(INT64) > limit) return 0;
+            *(INT64 *)(page + offset) += delta;
+            break;
+        default:
+            return 0;  /* leave the less common types to the client */
+        }
+    }
+    return 1;
+}
+
+/* get the modification time of a file with the best available resolution */
+static struct timespec get_file_mtime( const struct stat *st )
+{
+    struct timespec ts;
+
+#ifdef HAVE_STRUCT_STAT_ST_MTIM
+    ts = st->st_mtim;
+#elif defined(HAVE_STRUCT_STAT_ST_MTIMESPEC)
+    ts = st->st_mtimespec;
+#else
+    ts.tv_sec = st->st_mtime;
+    ts.tv_nsec = 0;
+#endif
+    return ts;
+}
+
+/* find an existing relocated file for a PE image mapping, if it is still up to date */
+static int find_relocated_mapping( struct mapping *mapping, const struct stat *st )
+{
+    struct timespec mtime = get_file_mtime( st );
+    struct shared_map *relocated;
+
+    if (!(relocated = get_shared_file( mapping->fd, mapping->image.map_addr ))) return 0;
+
+    if (relocated->file_size == st->st_size && relocated->file_mtime.tv_sec == mtime.tv_sec &&
+        relocated->file_mtime.tv_nsec == mtime.tv_nsec)
+    {
+        mapping->relocated = relocated;
+        mapping->image.has_relocated = 1;
+        return 1;
+    }
+    /* the file was modified since, don't let anybody else find the stale copy */
+    list_remove( &relocated->entry );
+    list_init( &relocated->entry );
+    release_object( relocated );
+    return 0;
+}
+
+/* allocate and fill the temp file for a PE image relocated to its mapping address */
+/* the file is shared by all the processes mapping the image at that address */
+/* this blocks the server while the image is read, so only small images are handled here */
+static void build_relocated_mapping( struct mapping *mapping )
+{
+    static const unsigned int sector_align = 0x1ff;
+    mem_size_t size = mapping->image.map_size;
+    mem_size_t delta = mapping->image.map_addr - mapping->image.base;
+    size_t align_mask = max( mapping->image.alignment - 1, page_mask );
+    size_t header_size = min( mapping->image.header_size, mapping->image.file_size );
+    size_t map_size, file_size;
+    off_t file_start;
+    IMAGE_DOS_HEADER *dos;
+    IMAGE_NT_HEADERS64 *nt;
+    IMAGE_SECTION_HEADER *sec;
+    IMAGE_DATA_DIRECTORY *dirs;
+    IMAGE_BASE_RELOCATION *rel, *end;
+    struct shared_map *relocated;
+    struct file *file;
+    struct stat st;
+    unsigned int i, nb_dirs;
+    int unix_fd, fd;
+    char *ptr;
+
+    if ((unix_fd = get_unix_fd( mapping->fd )) == -1) goto failed;
+    if (fstat( unix_fd, &st ) == -1) goto failed;
+    if (find_relocated_mapping( mapping, &st )) return;
+
+    /* the client takes care of images that need more than plain relocations */
+    if (mapping->shared || mapping->image.is_hybrid) return;
+    if (mapping->image.image_flags & IMAGE_FLAGS_ImageMappedFlat) return;
+    if (header_size > size || size > max_relocated_image_size) return;
+
+    if ((fd = create_temp_file( size )) == -1) goto failed;
+    if ((ptr = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 )) == MAP_FAILED)
+    {
+        close( fd );
+        goto failed;
+    }
+
+    /* lay out the headers and sections the same way the client would */
+
+    if (pread( unix_fd, ptr, header_size, 0 ) != header_size) goto error;
+    dos = (IMAGE_DOS_HEADER *)ptr;
+    if (header_size < sizeof(*nt) || dos->e_lfanew > header_size - sizeof(*nt)) goto error;
+    nt = (IMAGE_NT_HEADERS64 *)(ptr + dos->e_lfanew);
+    sec = IMAGE_FIRST_SECTION( nt );
+    if ((char *)(sec + nt->FileHeader.NumberOfSections) > ptr + header_size) goto error;
+
+    for (i = 0; i < nt->FileHeader.NumberOfSections; i++)
+    {
+        get_section_sizes( &sec[i], align_mask, &map_size, &file_start, &file_size );
+        if (sec[i].VirtualAddress > size || map_size > size - sec[i].VirtualAddress) goto error;
+        if (!sec[i].PointerToRawData || !file_size) continue;
+        if (sec[i].PointerToRawData >= mapping->image.file_size) goto error;
+        if (file_start + file_size > ((mapping->image.file_size + sector_align) & ~sector_align)) goto error;
+        if (pread( unix_fd, ptr + sec[i].VirtualAddress, file_size, file_start ) <= 0) goto error;
+    }
+
+    /* apply the relocations */
+
+    if (nt->OptionalHeader.Magic == IMAGE_NT_OPTIONAL_HDR64_MAGIC)
+    {
+        nt->OptionalHeader.ImageBase = mapping->image.map_addr;
+        nb_dirs = nt->OptionalHeader.NumberOfRvaAndSizes;
+        dirs = nt->OptionalHeader.DataDirectory;
+    }
+    else
+    {
+        IMAGE_NT_HEADERS32 *nt32 = (IMAGE_NT_HEADERS32 *)nt;
+        nt32->OptionalHeader.ImageBase = mapping->image.map_addr;
+        nb_dirs = nt32->OptionalHeader.NumberOfRvaAndSizes;
+        dirs = nt32->OptionalHeader.DataDirectory;
+    }
+    if (nb_dirs > IMAGE_DIRECTORY_ENTRY_BASERELOC &&
+        (char *)(dirs + IMAGE_DIRECTORY_ENTRY_BASERELOC + 1) <= ptr + header_size &&
+        dirs[IMAGE_DIRECTORY_ENTRY_BASERELOC].VirtualAddress &&
+        dirs[IMAGE_DIRECTORY_ENTRY_BASERELOC].Size)
+    {
+        IMAGE_DATA_DIRECTORY *dir = &dirs[IMAGE_DIRECTORY_ENTRY_BASERELOC];
+
+        if (dir->VirtualAddress > size || dir->Size > size - dir->VirtualAddress) goto error;
+        rel = (IMAGE_BASE_RELOCATION *)(ptr + dir->VirtualAddress);
+        end = (IMAGE_BASE_RELOCATION *)((char *)rel + dir->Size);
+        while (rel < end - 1 && rel->SizeOfBlock && rel->VirtualAddress < size)
+        {
+            if (rel->SizeOfBlock < sizeof(*rel) || rel->SizeOfBlock > (char *)end - (char *)rel) goto error;
+            if (!apply_relocation_block( ptr, size, rel, delta )) goto error;
+            rel = (IMAGE_BASE_RELOCATION *)((char *)rel + (rel->SizeOfBlock & ~1));
+        }
+    }
+
+    munmap( ptr, size );
+    if (!(file = create_file_for_fd( fd, FILE_GENERIC_READ, 0 ))) goto failed;
+    if (!(relocated = alloc_object( &shared_map_ops )))
+    {
+        release_object( file );
+        goto failed;
+    }
+    relocated->fd   = (struct fd *)grab_object( mapping->fd );
+    relocated->file = file;
+    relocated->base = mapping->image.map_addr;
+    relocated->file_size  = st.st_size;
+    relocated->file_mtime = get_file_mtime( &st );
+    list_add_head( &shared_map_list, &relocated->entry );
+    mapping->relocated = relocated;
+    mapping->image.has_relocated = 1;
+    return;
+
+error:
+    munmap( ptr, size );
+    close( fd );
+failed:
+    /* the relocated file is only an optimization, the client can still relocate the image */
+    clear_error();
+}
+
 /* load a data directory header from its section */
 static int load_data_dir( void *dir, size_t dir_size, size_t va, size_t size, size_t align_mask,
                           int unix_fd, IMAGE_SECTION_HEADER *sec, unsigned int nb_sec )
@@ -944,6 +1150,7 @@ static unsigned int get_image_params( struct mapping *mapping, file_pos_t file_s
 #undef GET_DATA_DIR
 
     mapping->image.is_hybrid     = 0;
+    mapping->image.has_relocated = 0;
     mapping->image.padding       = 0;
     mapping->image.map_addr      = get_fd_map_address( mapping->fd );
     mapping->image.image_charact = nt.FileHeader.Characteristics;
@@ -1074,6 +1281,7 @@ static bool mapping_init( struct object *obj, const void *init_data )
     mapping->flags       = data->flags;
     mapping->fd          = NULL;
     mapping->shared      = NULL;
+    mapping->relocated   = NULL;
     mapping->committed   = NULL;
     mapping->exp_name    = NULL;
     mapping->ver_res     = NULL;
@@ -1105,7 +1313,13 @@ static bool mapping_init( struct object *obj, const void *init_data )
         if (data->flags & SEC_IMAGE)
         {
             unsigned int err = get_image_params( mapping, st.st_size, unix_fd );
-            if (!err) return true;
+            if (!err)
+            {
+                /* another process may already have relocated the image to its map address */
+                if (mapping->image.map_addr && mapping->image.map_addr != mapping->image.base)
+                    find_relocated_mapping( mapping, &st );
+                return true;
+            }
             set_error( err );
             goto error;
         }
@@ -1250,6 +1464,7 @@ static void mapping_destroy( struct object *obj )
     if (mapping->fd) release_object( mapping->fd );
     if (mapping->committed) release_object( mapping->committed );
     if (mapping->shared) release_object( mapping->shared );
+    if (mapping->relocated) release_object( mapping->relocated );
     free( mapping->exp_name );
     free( mapping->ver_res );
 }
@@ -1513,6 +1728,12 @@ DECL_HANDLER(create_mapping)
         if (params.root) release_object( params.root );
         return;
     }
+    if ((data.flags & SEC_LARGE_PAGES) && !thread_single_check_privilege( current, SeLockMemoryPrivilege ))
+    {
+        if (params.root) release_object( params.root );
+        set_error( STATUS_PRIVILEGE_NOT_HELD );
+        return;
+    }
     if (req->file_handle)
     {
         if (!(file = get_file_obj( current->process, req->file_handle, req->file_access )))
@@ -1598,6 +1819,13 @@ DECL_HANDLER(get_image_map_address)
     {
         if (!mapping->image.map_addr) mapping->image.map_addr = assign_map_address( mapping );
         reply->addr = mapping->image.map_addr;
+        if (reply->addr && reply->addr != mapping->image.base)
+        {
+            if (!mapping->relocated) build_relocated_mapping( mapping );
+            if (mapping->relocated)
+                reply->relocated_file = alloc_handle( current->process, mapping->relocated->file,
+                                                      GENERIC_READ, 0 );
+        }
     }
     else set_error( STATUS_INVALID_PARAMETER );
 
@@ -1637,6 +1865,7 @@ DECL_HANDLER(map_view)
         view->fd        = !is_fd_removable( mapping->fd ) ? (struct fd *)grab_object( mapping->fd ) : NULL;
         view->committed = mapping->committed ? (struct ranges *)grab_object( mapping->committed ) : NULL;
         view->shared    = NULL;
+        view->relocated = NULL;
         add_process_view( current, view );
     }
 
@@ -1674,6 +1903,7 @@ DECL_HANDLER(map_image_view)
         view->fd        = !is_fd_removable( mapping->fd ) ? (struct fd *)grab_object( mapping->fd ) : NULL;
         view->committed = NULL;
         view->shared    = mapping->shared ? (struct shared_map *)grab_object( mapping->shared ) : NULL;
+        view->relocated = mapping->relocated ? (struct shared_map *)grab_object( mapping->relocated ) : NULL;
         view->image     = mapping->image;
         if (add_process_view( current, view ))
         {
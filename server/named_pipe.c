@@ -546,7 +546,7 @@ static void named_pipe_device_destroy( struct object *obj )
 {
     struct named_pipe_device *device = (struct named_pipe_device*)obj;
     assert( obj->ops == &named_pipe_device_ops );
-    free( device->pipes );
+    free_namespace( device->pipes );
 }
 
 struct object *create_named_pipe_device( struct object *root, struct unicode_str name,
@@ -918,8 +918,9 @@ static void message_queue_read( struct pipe_end *pipe_end, struct async *async )
         out_size = min( iosb->out_size, avail );
     }
 
+    /* fast path: the read consumes exactly the first message, whose buffer can be passed as-is */
     message = LIST_ENTRY( list_head(&pipe_end->message_queue), struct pipe_message, entry );
-    if (!message->read_pos && message->iosb->in_size == iosb->out_size) /* fast path */
+    if (!message->read_pos && message->iosb->in_size == out_size)
     {
         async_request_complete( async, status, out_size, out_size, message->iosb->in_data );
         message->iosb->in_data = NULL;
@@ -47,9 +47,12 @@
 struct namespace
 {
     unsigned int        hash_size;       /* size of hash table */
-    struct list         names[1];        /* array of hash entry lists */
+    unsigned int        count;           /* number of names in the namespace */
+    struct list        *names;           /* array of hash entry lists */
 };
 
+#define NAMESPACE_MAX_LOAD 4  /* average hash chain length that triggers a resize */
+
 
 struct type_descr no_type =
 {
@@ -210,11 +213,48 @@ void *memdup( const void *data, size_t len )
 
 /*****************************************************************/
 
+/* grow the hash table of a namespace and rehash its entries */
+static void grow_namespace( struct namespace *namespace )
+{
+    unsigned int i, hash, hash_size = namespace->hash_size * 4 + 1;
+    struct object_name *ptr;
+    struct list *names, *entry;
+
+    if (!(names = malloc( hash_size * sizeof(*names) ))) return;  /* keep using the current table */
+    for (i = 0; i < hash_size; i++) list_init( &names[i] );
+
+    for (i = 0; i < namespace->hash_size; i++)
+    {
+        while ((entry = list_head( &namespace->names[i] )))
+        {
+            ptr = LIST_ENTRY( entry, struct object_name, entry );
+            hash = hash_strW( ptr->name, ptr->len, hash_size );
+            list_remove( &ptr->entry );
+            list_add_tail( &names[hash], &ptr->entry );
+        }
+    }
+    free( namespace->names );
+    namespace->names = names;
+    namespace->hash_size = hash_size;
+}
+
 void namespace_add( struct namespace *namespace, struct object_name *ptr )
 {
-    unsigned int hash = hash_strW( ptr->name, ptr->len, namespace->hash_size );
+    unsigned int hash;
 
+    if (namespace->count >= namespace->hash_size * NAMESPACE_MAX_LOAD) grow_namespace( namespace );
+    hash = hash_strW( ptr->name, ptr->len, namespace->hash_size );
     list_add_head( &namespace->names[hash], &ptr->entry );
+    ptr->namespace = namespace;
+    namespace->count++;
+}
+
+/* remove a name from its namespace */
+void unlink_name( struct object_name *name )
+{
+    list_remove( &name->entry );
+    if (name->namespace) name->namespace->count--;
+    name->namespace = NULL;
 }
 
 /* allocate a name for an object */
@@ -226,6 +266,7 @@ static struct object_name *alloc_name( struct unicode_str name )
     {
         ptr->len = name.len;
         ptr->parent = NULL;
+        ptr->namespace = NULL;
         memcpy( ptr->name, name.str, name.len );
     }
     return ptr;
@@ -626,15 +667,26 @@ struct namespace *create_namespace( unsigned int hash_size )
     struct namespace *namespace;
     unsigned int i;
 
-    namespace = mem_alloc( sizeof(*namespace) + (hash_size - 1) * sizeof(namespace->names[0]) );
-    if (namespace)
+    if (!(namespace = mem_alloc( sizeof(*namespace) ))) return NULL;
+    if (!(namespace->names = mem_alloc( hash_size * sizeof(namespace->names[0]) )))
     {
-        namespace->hash_size      = hash_size;
-        for (i = 0; i < hash_size; i++) list_init( &namespace->names[i] );
+        free( namespace );
+        return NULL;
     }
+    namespace->hash_size      = hash_size;
+    namespace->count          = 0;
+    for (i = 0; i < hash_size; i++) list_init( &namespace->names[i] );
     return namespace;
 }
 
+/* free a namespace */
+void free_namespace( struct namespace *namespace )
+{
+    if (!namespace) return;
+    free( namespace->names );
+    free( namespace );
+}
+
 /* retrieve the file descriptor associated to an object, if any */
 struct fd *get_obj_fd( struct object *obj )
 {
@@ -148,6 +148,7 @@ struct object_name
     struct list         entry;           /* entry in the hash list */
     struct object      *obj;             /* object owning this name */
     struct object      *parent;          /* parent object */
+    struct namespace   *namespace;       /* namespace containing the name */
     data_size_t         len;             /* name length in bytes */
     WCHAR               name[1];
 };
@@ -165,6 +166,7 @@ extern void *mem_alloc( size_t size ) __WINE_ALLOC_SIZE(1) __WINE_DEALLOC(free)
 extern void *memdup( const void *data, size_t len ) __WINE_ALLOC_SIZE(2) __WINE_DEALLOC(free);
 extern void *alloc_object( const struct object_ops *ops );
 extern void namespace_add( struct namespace *namespace, struct object_name *ptr );
+extern void unlink_name( struct object_name *name );
 extern const WCHAR *get_object_name( struct object *obj, data_size_t *len );
 extern WCHAR *default_get_full_name( struct object *obj, data_size_t max, data_size_t *ret_len ) __WINE_DEALLOC(free) __WINE_MALLOC;
 extern void dump_object_name( struct object *obj );
@@ -176,6 +178,7 @@ obj_handle_t create_named_obj_handle( struct process *process, const struct obje
 extern void *open_named_object( const struct object_params *params );
 extern void unlink_named_object( struct object *obj );
 extern struct namespace *create_namespace( unsigned int hash_size );
+extern void free_namespace( struct namespace *namespace );
 extern void free_kernel_objects( struct object *obj );
 /* grab/release_object can take any pointer, but you better make sure */
 /* that the thing pointed to starts with a struct object... */
@@ -220,11 +223,6 @@ static inline unsigned int map_obj_access( struct object *obj, unsigned int acce
     return default_map_access( obj, access );
 }
 
-static inline void unlink_name( struct object_name *name )
-{
-    list_remove( &name->entry );
-}
-
 static inline void *mem_append( void *ptr, const void *src, data_size_t len )
 {
     if (!len) return ptr;
@@ -90,6 +90,7 @@ struct process
     struct list          rawinput_entry;  /* entry in the rawinput process list */
     struct list          kernel_object;   /* list of kernel object pointers */
     struct pe_image_info image_info;      /* main exe image info */
+    unsigned int         request_count;   /* number of server requests made by the process */
 };
 
 /* process functions */
@@ -77,6 +77,23 @@ struct type_descr key_type =
     },
 };
 
+/* hash table of the subkeys of a key, indexed by name */
+struct subkey_table
+{
+    unsigned int      size;        /* size of the hash table, 0 if not used */
+    unsigned int      count;       /* count of used entries */
+    struct key      **entries;     /* subkeys, NULL for free entries */
+};
+
+/* hash table of the values of a key, indexed by name */
+struct value_table
+{
+    unsigned int      size;        /* size of the hash table, 0 if not used */
+    unsigned int      count;       /* count of used entries */
+    int               base;        /* offset of the array indexes stored in the entries */
+    int              *entries;     /* values array index + base + 1, 0 for free entries */
+};
+
 /* a registry key */
 struct key
 {
@@ -85,11 +102,15 @@ struct key
     data_size_t       classlen;    /* length of class name */
     int               last_subkey; /* last in use subkey */
     int               nb_subkeys;  /* count of allocated subkeys */
+    int               sorted_subkeys; /* count of sorted subkeys, others are appended unsorted */
     struct key      **subkeys;     /* subkeys array */
+    struct subkey_table subkey_table; /* hash table of the subkeys */
     struct key       *wow6432node; /* Wow6432Node subkey */
     int               last_value;  /* last in use value */
     int               nb_values;   /* count of allocated values in array */
+    int               sorted_values; /* count of sorted values, others are appended unsorted */
     struct key_value *values;      /* values array */
+    struct value_table value_table; /* hash table of the values */
     unsigned int      flags;       /* flags */
     timeout_t         modif;       /* last modification time */
     struct list       notify_list; /* list of notifications */
@@ -117,6 +138,7 @@ struct key_value
 
 #define MIN_SUBKEYS  8   /* min. number of allocated subkeys per key */
 #define MIN_VALUES   8   /* min. number of allocated values per key */
+#define MIN_HASHED_ENTRIES 128  /* min. number of subkeys or values for using a hash index */
 
 #define MAX_NAME_LEN  256    /* max. length of a key name */
 #define MAX_VALUE_LEN 16383  /* max. length of a value name */
@@ -238,6 +260,8 @@ static void dump_path( const struct key *key, const struct key *base, FILE *f )
 /* dump a value to a text file */
 static void dump_value( const struct key_value *value, FILE *f )
 {
+    static const char hex[16] = "0123456789abcdef";
+    char buffer[256], *pos = buffer;
     unsigned int i, dw;
     int count;
 
@@ -275,34 +299,336 @@ static void dump_value( const struct key_value *value, FILE *f )
     else count += fprintf( f, "hex(%x):", value->type );
     for (i = 0; i < value->len; i++)
     {
-        count += fprintf( f, "%02x", *((unsigned char *)value->data + i) );
+        unsigned char ch = *((unsigned char *)value->data + i);
+
+        if (pos > buffer + sizeof(buffer) - 8)
+        {
+            fwrite( buffer, pos - buffer, 1, f );
+            pos = buffer;
+        }
+        *pos++ = hex[ch >> 4];
+        *pos++ = hex[ch & 0x0f];
+        count += 2;
         if (i < value->len-1)
         {
-            fputc( ',', f );
+            *pos++ = ',';
             if (++count > 76)
             {
-                fprintf( f, "\\\n  " );
+                memcpy( pos, "\\\n  ", 4 );
+                pos += 4;
                 count = 2;
             }
         }
     }
-    fputc( '\n', f );
+    *pos++ = '\n';
+    fwrite( buffer, pos - buffer, 1, f );
+}
+
+/* compare two key or value names, using the same ordering as the sorted arrays */
+static inline int compare_names( const WCHAR *str1, data_size_t len1, const WCHAR *str2, data_size_t len2 )
+{
+    int res = memicmp_strW( str1, str2, min( len1, len2 ) );
+    if (!res) res = len1 - len2;
+    return res;
+}
+
+static int compare_subkeys( const void *ptr1, const void *ptr2 )
+{
+    const struct key *key1 = *(struct key * const *)ptr1;
+    const struct key *key2 = *(struct key * const *)ptr2;
+
+    return compare_names( key1->obj.name->name, key1->obj.name->len, key2->obj.name->name, key2->obj.name->len );
+}
+
+static int compare_values( const void *ptr1, const void *ptr2 )
+{
+    const struct key_value *value1 = ptr1;
+    const struct key_value *value2 = ptr2;
+
+    return compare_names( value1->name, value1->namelen, value2->name, value2->namelen );
+}
+
+/* sort an array whose first entries are already sorted, by sorting the other ones and merging them in */
+static void sort_array_tail( void *base, int count, int sorted, size_t size,
+                             int (*compare)( const void *, const void * ) )
+{
+    char *array = base, *tail;
+    int i = sorted - 1, j = count - sorted - 1, dst = count - 1;
+
+    if (!sorted || !(tail = memdup( array + sorted * size, (count - sorted) * size )))
+    {
+        qsort( array, count, size, compare );
+        return;
+    }
+    qsort( tail, count - sorted, size, compare );
+    while (j >= 0)
+    {
+        if (i >= 0 && compare( array + i * size, tail + j * size ) > 0)
+            memcpy( array + dst-- * size, array + i-- * size, size );
+        else
+            memcpy( array + dst-- * size, tail + j-- * size, size );
+    }
+    free( tail );
+}
+
+/* make sure that the subkeys array is sorted */
+static void sort_subkeys( struct key *key )
+{
+    int count = key->last_subkey + 1;
+
+    if (key->sorted_subkeys == count) return;
+    sort_array_tail( key->subkeys, count, key->sorted_subkeys, sizeof(*key->subkeys), compare_subkeys );
+    key->sorted_subkeys = count;
+}
+
+/* get the hash table size for a given number of entries, leaving room for as many new ones */
+static unsigned int get_hash_table_size( int count )
+{
+    unsigned int size = 4 * MIN_HASHED_ENTRIES;
+
+    while (size < 4 * count) size *= 2;
+    return size;
+}
+
+/* check if a hash table entry can be moved to a free slot without becoming unreachable */
+static inline int can_move_entry( unsigned int hash, unsigned int free_pos, unsigned int pos )
+{
+    /* the entry must stay in place if its hash is cyclically in (free_pos, pos] */
+    if (free_pos <= pos) return hash <= free_pos || hash > pos;
+    return hash <= free_pos && hash > pos;
+}
+
+static inline unsigned int hash_subkey( const struct subkey_table *table, const struct key *subkey )
+{
+    return hash_strW( subkey->obj.name->name, subkey->obj.name->len, table->size );
+}
+
+static struct key *subkey_table_find( const struct subkey_table *table, struct unicode_str name )
+{
+    unsigned int i;
+    struct key *subkey;
+
+    for (i = hash_strW( name.str, name.len, table->size ); (subkey = table->entries[i]);
+         i = (i + 1) & (table->size - 1))
+    {
+        if (subkey->obj.name->len == name.len && !memicmp_strW( subkey->obj.name->name, name.str, name.len ))
+            return subkey;
+    }
+    return NULL;
+}
+
+/* add a subkey to the hash table; return 0 if the table needs to be grown */
+static int subkey_table_add( struct subkey_table *table, struct key *subkey )
+{
+    unsigned int i;
+
+    if (2 * (table->count + 1) > table->size) return 0;
+    for (i = hash_subkey( table, subkey ); table->entries[i]; i = (i + 1) & (table->size - 1)) ;
+    table->entries[i] = subkey;
+    table->count++;
+    return 1;
+}
+
+/* remove a subkey from the hash table; its name is passed separately since it may be already unlinked */
+static void subkey_table_remove( struct subkey_table *table, struct unicode_str name, const struct key *subkey )
+{
+    unsigned int i, j;
+    struct key *entry;
+
+    for (i = hash_strW( name.str, name.len, table->size ); table->entries[i] != subkey;
+         i = (i + 1) & (table->size - 1))
+        assert( table->entries[i] );
+
+    /* move back the following entries that would become unreachable */
+    for (j = (i + 1) & (table->size - 1); (entry = table->entries[j]); j = (j + 1) & (table->size - 1))
+    {
+        if (!can_move_entry( hash_subkey( table, entry ), i, j )) continue;
+        table->entries[i] = entry;
+        i = j;
+    }
+    table->entries[i] = NULL;
+    table->count--;
+}
+
+/* (re)build the subkeys hash table of a key; return 0 on error */
+static int build_subkey_table( struct key *key )
+{
+    struct subkey_table *table = &key->subkey_table;
+    unsigned int size = get_hash_table_size( key->last_subkey + 1 );
+    struct key **entries;
+    int i;
+
+    if (!(entries = malloc( size * sizeof(*entries) ))) return 0;
+    memset( entries, 0, size * sizeof(*entries) );
+    free( table->entries );
+    table->entries = entries;
+    table->size    = size;
+    table->count   = 0;
+    for (i = 0; i <= key->last_subkey; i++) subkey_table_add( table, key->subkeys[i] );
+    return 1;
+}
+
+/* free the subkeys hash table, the subkeys array then needs to be kept sorted */
+static void free_subkey_table( struct key *key )
+{
+    free( key->subkey_table.entries );
+    memset( &key->subkey_table, 0, sizeof(key->subkey_table) );
+    sort_subkeys( key );
+}
+
+/* update the subkeys hash table after a subkey has been added to the array */
+static void add_subkey_table( struct key *key, struct key *subkey )
+{
+    if (!key->subkey_table.size)
+    {
+        key->sorted_subkeys = key->last_subkey + 1;
+        if (key->sorted_subkeys >= MIN_HASHED_ENTRIES) build_subkey_table( key );
+    }
+    else if (!subkey_table_add( &key->subkey_table, subkey ) && !build_subkey_table( key ))
+        free_subkey_table( key );
+}
+
+/* update the subkeys hash table after a subkey has been removed from the array */
+static void remove_subkey_table( struct key *key, struct unicode_str name, const struct key *subkey )
+{
+    if (!key->subkey_table.size) return;
+    subkey_table_remove( &key->subkey_table, name, subkey );
+    if (key->subkey_table.count < MIN_HASHED_ENTRIES / 2) free_subkey_table( key );
+}
+
+static inline unsigned int hash_value( const struct value_table *table, const struct key *key, int entry )
+{
+    const struct key_value *value = &key->values[entry - table->base - 1];
+
+    return hash_strW( value->name, value->namelen, table->size );
+}
+
+/* find a value in the hash table and return its index in the values array, or -1 if not found */
+static int value_table_find( const struct value_table *table, const struct key *key, struct unicode_str name )
+{
+    const struct key_value *value;
+    unsigned int i;
+    int entry;
+
+    for (i = hash_strW( name.str, name.len, table->size ); (entry = table->entries[i]);
+         i = (i + 1) & (table->size - 1))
+    {
+        value = &key->values[entry - table->base - 1];
+        if (value->namelen == name.len && !memicmp_strW( value->name, name.str, name.len ))
+            return entry - table->base - 1;
+    }
+    return -1;
+}
+
+/* add a value to the hash table; return 0 if the table needs to be grown */
+static int value_table_add( struct value_table *table, struct unicode_str name, int index )
+{
+    unsigned int i;
+
+    if (2 * (table->count + 1) > table->size) return 0;
+    for (i = hash_strW( name.str, name.len, table->size ); table->entries[i]; i = (i + 1) & (table->size - 1)) ;
+    table->entries[i] = index + table->base + 1;
+    table->count++;
+    return 1;
+}
+
+/* remove a value from the hash table, before it gets removed from the values array */
+static void value_table_remove( struct value_table *table, const struct key *key, int index )
+{
+    unsigned int i, j;
+    int entry, *entries = table->entries;
+
+    for (i = hash_value( table, key, index + table->base + 1 ); entries[i] != index + table->base + 1;
+         i = (i + 1) & (table->size - 1))
+        assert( entries[i] );
+
+    /* move back the following entries that would become unreachable */
+    for (j = (i + 1) & (table->size - 1); (entry = entries[j]); j = (j + 1) & (table->size - 1))
+    {
+        if (!can_move_entry( hash_value( table, key, entry ), i, j )) continue;
+        entries[i] = entry;
+        i = j;
+    }
+    entries[i] = 0;
+    table->count--;
+
+    /* the following values are going to be moved down by one in the array */
+    if (index == key->last_value) return;
+    if (!index) table->base++;
+    else
+    {
+        int limit = index + table->base + 1;
+        for (i = 0; i < table->size; i++) entries[i] -= (entries[i] > limit);
+    }
+}
+
+/* (re)build the values hash table of a key; return 0 on error */
+static int build_value_table( struct key *key )
+{
+    struct value_table *table = &key->value_table;
+    unsigned int size = get_hash_table_size( key->last_value + 1 );
+    struct unicode_str name;
+    int i, *entries;
+
+    if (!(entries = malloc( size * sizeof(*entries) ))) return 0;
+    memset( entries, 0, size * sizeof(*entries) );
+    free( table->entries );
+    table->entries = entries;
+    table->size    = size;
+    table->count   = 0;
+    table->base    = 0;
+    for (i = 0; i <= key->last_value; i++)
+    {
+        name.str = key->values[i].name;
+        name.len = key->values[i].namelen;
+        value_table_add( table, name, i );
+    }
+    return 1;
+}
+
+/* make sure that the values array is sorted */
+static void sort_values( struct key *key )
+{
+    int count = key->last_value + 1;
+
+    if (key->sorted_values == count) return;
+    sort_array_tail( key->values, count, key->sorted_values, sizeof(*key->values), compare_values );
+    key->sorted_values = count;
+    /* the hash table stores array indexes, so it needs to be rebuilt */
+    if (key->value_table.size && !build_value_table( key ))
+    {
+        free( key->value_table.entries );
+        memset( &key->value_table, 0, sizeof(key->value_table) );
+    }
+}
+
+/* free the values hash table, the values array then needs to be kept sorted */
+static void free_value_table( struct key *key )
+{
+    free( key->value_table.entries );
+    memset( &key->value_table, 0, sizeof(key->value_table) );
+    sort_values( key );
 }
 
 /* find the named child of a given key and return its index */
 static struct key *find_subkey( const struct key *key, struct unicode_str name, int *index )
 {
     int i, min, max, res;
-    data_size_t len;
+
+    if (key->subkey_table.size)
+    {
+        /* new subkeys are appended to the array when the hash table is used */
+        *index = key->last_subkey + 1;
+        return subkey_table_find( &key->subkey_table, name );
+    }
 
     min = 0;
     max = key->last_subkey;
     while (min <= max)
     {
         i = (min + max) / 2;
-        len = min( key->subkeys[i]->obj.name->len, name.len );
-        res = memicmp_strW( key->subkeys[i]->obj.name->name, name.str, len );
-        if (!res) res = key->subkeys[i]->obj.name->len - name.len;
+        res = compare_names( key->subkeys[i]->obj.name->name, key->subkeys[i]->obj.name->len,
+                             name.str, name.len );
         if (!res)
         {
             *index = i;
@@ -341,11 +667,13 @@ static int grow_subkeys( struct key *key )
 }
 
 /* save a registry and all its subkeys to a text file */
-static void save_subkeys( const struct key *key, const struct key *base, FILE *f )
+static void save_subkeys( struct key *key, const struct key *base, FILE *f )
 {
     int i;
 
     if (key->flags & KEY_VOLATILE) return;
+    sort_subkeys( key );
+    sort_values( key );
     /* save key if it has either some values or no subkeys, or needs special options */
     /* keys with no values but subkeys are saved implicitly by saving the subkeys */
     if ((key->last_value >= 0) || (key->last_subkey == -1) || key->class || (key->flags & KEY_SYMLINK))
@@ -398,11 +726,15 @@ static bool key_init( struct object *obj, const void *init_data )
     key->flags       = 0;
     key->last_subkey = -1;
     key->nb_subkeys  = 0;
+    key->sorted_subkeys = 0;
     key->subkeys     = NULL;
     key->wow6432node = NULL;
     key->nb_values   = 0;
     key->last_value  = -1;
+    key->sorted_values = 0;
     key->values      = NULL;
+    memset( &key->subkey_table, 0, sizeof(key->subkey_table) );
+    memset( &key->value_table, 0, sizeof(key->value_table) );
     key->modif       = data->modif;
     list_init( &key->notify_list );
 
@@ -641,6 +973,8 @@ static int key_link_name( struct object *obj, struct object_name *name, struct o
     for (i = ++parent_key->last_subkey; i > index; i--)
         parent_key->subkeys[i] = parent_key->subkeys[i - 1];
     parent_key->subkeys[index] = (struct key *)grab_object( key );
+    key->obj.name = name;  /* needed by the hash table, the caller sets it afterwards anyway */
+    add_subkey_table( parent_key, key );
     if (is_wow6432node( name->name, name->len ) &&
         !is_wow6432node( parent_key->obj.name->name, parent_key->obj.name->len ))
         parent_key->wow6432node = key;
@@ -652,6 +986,7 @@ static void key_unlink_name( struct object *obj, struct object_name *name )
 {
     struct key *key = (struct key *)obj;
     struct key *parent = (struct key *)name->parent;
+    struct unicode_str str;
     int i, nb_subkeys;
 
     if (!parent) return;
@@ -662,10 +997,15 @@ static void key_unlink_name( struct object *obj, struct object_name *name )
         return;
     }
 
-    for (i = 0; i <= parent->last_subkey; i++) if (parent->subkeys[i] == key) break;
-    assert( i <= parent->last_subkey );
+    /* search from the end, recursive deletion removes the last subkey first */
+    for (i = parent->last_subkey; i >= 0; i--) if (parent->subkeys[i] == key) break;
+    assert( i >= 0 );
+    if (i < parent->sorted_subkeys) parent->sorted_subkeys--;
     for ( ; i < parent->last_subkey; i++) parent->subkeys[i] = parent->subkeys[i + 1];
     parent->last_subkey--;
+    str.str = name->name;
+    str.len = name->len;
+    remove_subkey_table( parent, str, key );
     name->parent = NULL;
     if (parent->wow6432node == key) parent->wow6432node = NULL;
     release_object( key );
@@ -706,12 +1046,14 @@ static void key_destroy( struct object *obj )
         free( key->values[i].data );
     }
     free( key->values );
+    free( key->value_table.entries );
     for (i = 0; i <= key->last_subkey; i++)
     {
         key->subkeys[i]->obj.name->parent = NULL;
         release_object( key->subkeys[i] );
     }
     free( key->subkeys );
+    free( key->subkey_table.entries );
     /* unconditionally notify everything waiting on this key */
     while ((ptr = list_head( &key->notify_list )))
     {
@@ -866,6 +1208,7 @@ static void enum_key( struct key *key, int index, int info_class, struct enum_ke
             set_error( STATUS_NO_MORE_ENTRIES );
             return;
         }
+        sort_subkeys( key );
         key = key->subkeys[index];
     }
 
@@ -980,6 +1323,16 @@ static void rename_key( struct key *key, struct unicode_str new_name )
     for (cur_index = 0; cur_index <= parent->last_subkey; cur_index++)
         if (parent->subkeys[cur_index] == key) break;
 
+    if (parent->subkey_table.size)
+    {
+        /* the key gets moved to the unsorted end of the array */
+        struct unicode_str str;
+
+        str.str = key->obj.name->name;
+        str.len = key->obj.name->len;
+        subkey_table_remove( &parent->subkey_table, str, key );
+        if (cur_index < parent->sorted_subkeys) parent->sorted_subkeys--;
+    }
     if (cur_index < index)
     {
         --index;
@@ -993,6 +1346,7 @@ static void rename_key( struct key *key, struct unicode_str new_name )
 
     free( key->obj.name );
     key->obj.name = new_name_ptr;
+    if (parent->subkey_table.size) add_subkey_table( parent, key );
 
     if (debug_level > 1) dump_operation( key, NULL, "Rename" );
     touch_key( key, REG_NOTIFY_CHANGE_NAME );
@@ -1063,16 +1417,25 @@ static int grow_values( struct key *key )
 static struct key_value *find_value( const struct key *key, struct unicode_str name, int *index )
 {
     int i, min, max, res;
-    data_size_t len;
+
+    if (key->value_table.size)
+    {
+        /* new values are appended to the array when the hash table is used */
+        if ((i = value_table_find( &key->value_table, key, name )) == -1)
+        {
+            *index = key->last_value + 1;
+            return NULL;
+        }
+        *index = i;
+        return &key->values[i];
+    }
 
     min = 0;
     max = key->last_value;
     while (min <= max)
     {
         i = (min + max) / 2;
-        len = min( key->values[i].namelen, name.len );
-        res = memicmp_strW( key->values[i].name, name.str, len );
-        if (!res) res = key->values[i].namelen - name.len;
+        res = compare_names( key->values[i].name, key->values[i].namelen, name.str, name.len );
         if (!res)
         {
             *index = i;
@@ -1108,6 +1471,17 @@ static struct key_value *insert_value( struct key *key, struct unicode_str name,
     value->namelen = name.len;
     value->len     = 0;
     value->data    = NULL;
+
+    if (!key->value_table.size)
+    {
+        key->sorted_values = key->last_value + 1;
+        if (key->sorted_values >= MIN_HASHED_ENTRIES) build_value_table( key );
+    }
+    else if (!value_table_add( &key->value_table, name, index ) && !build_value_table( key ))
+    {
+        free_value_table( key );
+        value = find_value( key, name, &index );  /* the array has been sorted */
+    }
     return value;
 }
 
@@ -1208,6 +1582,7 @@ static void enum_value( struct key *key, int i, int info_class, struct enum_key_
         void *data;
         data_size_t namelen, maxlen;
 
+        sort_values( key );
         value = &key->values[i];
         reply->type = value->type;
         namelen = value->namelen;
@@ -1266,10 +1641,13 @@ static void delete_value( struct key *key, struct unicode_str name )
         return;
     }
     if (debug_level > 1) dump_operation( key, value, "Delete" );
+    if (key->value_table.size) value_table_remove( &key->value_table, key, index );
     free( value->name );
     free( value->data );
+    if (index < key->sorted_values) key->sorted_values--;
     for (i = index; i < key->last_value; i++) key->values[i] = key->values[i + 1];
     key->last_value--;
+    if (key->value_table.size && key->value_table.count < MIN_HASHED_ENTRIES / 2) free_value_table( key );
     touch_key( key, REG_NOTIFY_CHANGE_LAST_SET );
 
     /* try to shrink the array */
@@ -1508,15 +1886,18 @@ static int parse_hex( unsigned char *dest, data_size_t *len, const char *buffer
 {
     const char *p = buffer;
     data_size_t count = 0;
-    char *end;
 
     while (isxdigit(*p))
     {
-        unsigned int val = strtoul( p, &end, 16 );
-        if (end == p || val > 0xff) return -1;
+        unsigned int val = 0;
+
+        do
+        {
+            val = val * 16 + (*p <= '9' ? *p - '0' : (*p | 0x20) - 'a' + 10);
+            if (val > 0xff) return -1;
+        } while (isxdigit(*++p));
         if (count++ >= *len) return -1;  /* dest buffer overflow */
         *dest++ = val;
-        p = end;
         while (isspace(*p)) p++;
         if (*p == ',') p++;
         while (isspace(*p)) p++;
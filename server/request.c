@@ -101,9 +101,13 @@ char *server_dir = NULL;   /* server directory */
 int server_dir_fd = -1;    /* file descriptor for the server dir */
 int config_dir_fd = -1;    /* file descriptor for the config dir */
 
+#define REQUEST_BUFFER_SIZE 1024  /* size of the per-thread buffer for small request data */
+
 static struct master_socket *master_socket;  /* the master socket object */
 static struct timeout_user *master_timeout;
 
+struct request_stats request_stats[REQ_NB_REQUESTS];  /* per-request statistics */
+
 /* complain about a protocol error and terminate the client connection */
 void fatal_protocol_error( struct thread *thread, const char *err, ... )
 {
@@ -267,11 +271,25 @@ static void send_reply( union generic_reply *reply )
         fatal_protocol_error( current, "reply write: %s\n", strerror( errno ));
 }
 
+/* account the time spent handling a request */
+static void update_request_stats( enum request req, timeout_t time )
+{
+    struct request_stats *stats = &request_stats[req];
+    unsigned int bucket = 0;
+
+    while (time >> bucket && bucket < REQUEST_STATS_BUCKETS - 1) bucket++;
+    stats->count++;
+    stats->total_time += time;
+    if (time > stats->max_time) stats->max_time = time;
+    stats->histogram[bucket]++;
+}
+
 /* call a request handler */
 static void call_req_handler( struct thread *thread )
 {
     union generic_reply reply;
     enum request req = thread->req.request_header.req;
+    timeout_t start;
 
     current = thread;
     current->reply_size = 0;
@@ -281,7 +299,12 @@ static void call_req_handler( struct thread *thread )
     if (debug_level) trace_request();
 
     if (req < REQ_NB_REQUESTS)
+    {
+        thread->process->request_count++;
+        start = monotonic_counter();
         req_handlers[req]( &current->req, &reply );
+        update_request_stats( req, monotonic_counter() - start );
+    }
     else
         set_error( STATUS_NOT_IMPLEMENTED );
 
@@ -310,18 +333,39 @@ void read_request( struct thread *thread )
 
     if (!thread->req_toread)  /* no pending request */
     {
-        if ((ret = read( get_unix_fd( thread->request_fd ), &thread->req,
-                         sizeof(thread->req) )) != sizeof(thread->req)) goto error;
-        if (!(thread->req_toread = thread->req.request_header.request_size))
+        struct iovec vec[2];
+        data_size_t size;
+
+        /* small request data is read along with the header, into a buffer kept across requests */
+        if (!thread->req_buffer) thread->req_buffer = malloc( REQUEST_BUFFER_SIZE );
+        vec[0].iov_base = &thread->req;
+        vec[0].iov_len  = sizeof(thread->req);
+        vec[1].iov_base = thread->req_buffer;
+        vec[1].iov_len  = thread->req_buffer ? REQUEST_BUFFER_SIZE : 0;
+
+        if ((ret = readv( get_unix_fd( thread->request_fd ), vec, 2 )) < (int)sizeof(thread->req))
+            goto error;
+        ret -= sizeof(thread->req);
+        size = thread->req.request_header.request_size;
+        if ((data_size_t)ret > size)
+        {
+            fatal_protocol_error( thread, "request data overflow %u > %u\n", ret, size );
+            return;
+        }
+        if (!(thread->req_toread = size - ret))
         {
-            /* no data, handle request at once */
+            /* no data, or all of it already received, handle request at once */
+            thread->req_data = size ? thread->req_buffer : NULL;
             call_req_handler( thread );
+            thread->req_data = NULL;
             return;
         }
-        if (!(thread->req_data = malloc( thread->req_toread )))
+        if (size <= vec[1].iov_len) thread->req_data = thread->req_buffer;
+        else if ((thread->req_data = malloc( size ))) memcpy( thread->req_data, thread->req_buffer, ret );
+        else
         {
             fatal_protocol_error( thread, "no memory for %u bytes request %d\n",
-                                  thread->req_toread, thread->req.request_header.req );
+                                  size, thread->req.request_header.req );
             return;
         }
     }
@@ -337,7 +381,7 @@ void read_request( struct thread *thread )
         if (!(thread->req_toread -= ret))
         {
             call_req_handler( thread );
-            free( thread->req_data );
+            if (thread->req_data != thread->req_buffer) free( thread->req_data );
             thread->req_data = NULL;
             return;
         }
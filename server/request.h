@@ -63,6 +63,21 @@ extern int server_dir_fd, config_dir_fd;
 
 extern void trace_request(void);
 extern void trace_reply( enum request req, const union generic_reply *reply );
+extern void dump_request_stats(void);
+
+/* request statistics */
+
+#define REQUEST_STATS_BUCKETS 20
+
+struct request_stats
+{
+    unsigned int count;                               /* number of requests handled */
+    timeout_t    total_time;                          /* total time spent in the handler */
+    timeout_t    max_time;                            /* longest time spent in the handler */
+    unsigned int histogram[REQUEST_STATS_BUCKETS];    /* count by log2 of the time in ticks */
+};
+
+extern struct request_stats request_stats[];
 
 /* get current tick count to return to client */
 static inline unsigned int get_tick_count(void)
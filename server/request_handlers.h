@@ -1108,7 +1108,8 @@ C_ASSERT( sizeof(struct get_mapping_info_reply) == 40 );
 C_ASSERT( offsetof(struct get_image_map_address_request, handle) == 12 );
 C_ASSERT( sizeof(struct get_image_map_address_request) == 16 );
 C_ASSERT( offsetof(struct get_image_map_address_reply, addr) == 8 );
-C_ASSERT( sizeof(struct get_image_map_address_reply) == 16 );
+C_ASSERT( offsetof(struct get_image_map_address_reply, relocated_file) == 16 );
+C_ASSERT( sizeof(struct get_image_map_address_reply) == 24 );
 C_ASSERT( offsetof(struct map_view_request, mapping) == 12 );
 C_ASSERT( offsetof(struct map_view_request, access) == 16 );
 C_ASSERT( offsetof(struct map_view_request, base) == 24 );
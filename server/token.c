@@ -41,6 +41,7 @@
 
 #define MAX_SUBAUTH_COUNT 1
 
+const struct luid SeLockMemoryPrivilege           = {  4, 0 };
 const struct luid SeIncreaseQuotaPrivilege        = {  5, 0 };
 const struct luid SeTcbPrivilege                  = {  7, 0 };
 const struct luid SeSecurityPrivilege             = {  8, 0 };
@@ -750,6 +751,7 @@ struct token *token_create_admin( unsigned primary, int impersonation_level, int
         { SeIncreaseBasePriorityPrivilege, 0 },
         { SeLoadDriverPrivilege, SE_PRIVILEGE_ENABLED },
         { SeCreatePagefilePrivilege, 0 },
+        { SeLockMemoryPrivilege, 0 },
         { SeIncreaseQuotaPrivilege, 0 },
         { SeUndockPrivilege, 0 },
         { SeManageVolumePrivilege, 0 },
@@ -55,6 +55,7 @@
 #include "ws2tcpip.h"
 #include "tcpmib.h"
 #include "file.h"
+#include "process.h"
 #include "request.h"
 #include "security.h"
 #include "unicode.h"
@@ -1519,6 +1520,25 @@ static void dump_varargs_rawinput_devices(const char *prefix, data_size_t size )
     fputc( '}', stderr );
 }
 
+static void dump_varargs_completion_infos( const char *prefix, data_size_t size )
+{
+    const struct completion_info *info;
+
+    fprintf( stderr, "%s{", prefix );
+    while (size >= sizeof(*info))
+    {
+        info = cur_data;
+        dump_uint64( "{ckey=", &info->ckey );
+        dump_uint64( ",cvalue=", &info->cvalue );
+        dump_uint64( ",information=", &info->information );
+        fprintf( stderr, ",status=%08x}", info->status );
+        size -= sizeof(*info);
+        remove_data( sizeof(*info) );
+        if (size) fputc( ',', stderr );
+    }
+    fputc( '}', stderr );
+}
+
 static void dump_varargs_handle_infos( const char *prefix, data_size_t size )
 {
     const struct handle_info *handle;
@@ -1703,6 +1723,45 @@ void trace_request(void)
     else fprintf( stderr, "%04x: %d(?)\n", current->id, req );
 }
 
+static timeout_t request_stats_time;  /* time of the last statistics dump */
+
+static int dump_process_request_stats( struct process *process, void *arg )
+{
+    timeout_t elapsed = current_time - max( process->start_time, request_stats_time );
+
+    fprintf( stderr, "%04x: %10u requests %10u/s ", process->id, process->request_count,
+             elapsed > 0 ? (unsigned int)(process->request_count * TICKS_PER_SEC / elapsed) : 0 );
+    if (process->image) dump_strW( process->image, process->imagelen, stderr, "\"\"" );
+    fputc( '\n', stderr );
+    process->request_count = 0;
+    return 0;
+}
+
+/* dump the per-request and per-process statistics gathered since the previous dump, and reset them */
+void dump_request_stats(void)
+{
+    unsigned int i, j;
+
+    fprintf( stderr, "request statistics for the last %.3f s\n",
+             (current_time - max( server_start_time, request_stats_time )) / (double)TICKS_PER_SEC );
+    fprintf( stderr, "%-32s %10s %12s %10s %10s  histogram (log2 of 100ns ticks)\n",
+             "request", "count", "total (ms)", "avg (us)", "max (us)" );
+    for (i = 0; i < REQ_NB_REQUESTS; i++)
+    {
+        const struct request_stats *stats = &request_stats[i];
+
+        if (!stats->count) continue;
+        fprintf( stderr, "%-32s %10u %12.3f %10.3f %10.3f ", req_names[i], stats->count,
+                 stats->total_time / 10000.0, stats->total_time / 10.0 / stats->count,
+                 stats->max_time / 10.0 );
+        for (j = 0; j < REQUEST_STATS_BUCKETS; j++) fprintf( stderr, " %u", stats->histogram[j] );
+        fputc( '\n', stderr );
+    }
+    enum_processes( dump_process_request_stats, NULL );
+    memset( request_stats, 0, REQ_NB_REQUESTS * sizeof(*request_stats) );
+    request_stats_time = current_time;
+}
+
 void trace_reply( enum request req, const union generic_reply *reply )
 {
     if (req < REQ_NB_REQUESTS)